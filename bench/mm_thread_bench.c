@@ -0,0 +1,157 @@
+/* source: mm_thread_bench.c
+ * Copyright (c) 2026-2028, Lishanwen
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <sgl_mm.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+
+#if (CONFIG_SGL_MM_THREAD_NUM < 4)
+#error "the benchmark needs CONFIG_SGL_MM_THREAD_NUM >= 4"
+#endif
+
+
+#define  POOL_SIZE                               (1024 * 1024)
+#define  THREAD_MAX                              (4)
+#define  ITER_NUM                                (400000)
+#define  SLOT_NUM                                (64)
+
+
+static uint8_t pool[POOL_SIZE];
+static pthread_mutex_t mm_mutex = PTHREAD_MUTEX_INITIALIZER;
+static __thread int thread_index = -1;
+static int bad = 0;
+
+
+static void mm_lock(void)
+{
+    pthread_mutex_lock(&mm_mutex);
+}
+
+
+static void mm_unlock(void)
+{
+    pthread_mutex_unlock(&mm_mutex);
+}
+
+
+static int mm_thread_id(void)
+{
+    return thread_index;
+}
+
+
+/**
+ * @brief  random malloc and free of 8 to 248 bytes, the content of block is checked before free
+ * @param  arg  index of thread
+ * @return NULL
+ */
+static void* worker(void *arg)
+{
+    void *slot[SLOT_NUM] = {0};
+    unsigned int r;
+    size_t size;
+    int k, err = 0;
+
+    thread_index = (int)(long)arg;
+    r = 1234 + thread_index;
+
+    for (int i = 0; i < ITER_NUM; i++) {
+        r = r * 1103515245 + 12345;
+        k = (r >> 8) & (SLOT_NUM - 1);
+
+        if (slot[k] != NULL) {
+            err += ((uint8_t*)slot[k])[0] != (uint8_t)k;
+            sgl_free(slot[k]);
+            slot[k] = NULL;
+        }
+        else {
+            size = 8 + ((r >> 16) % 240);
+            slot[k] = sgl_malloc(size);
+            if (slot[k] != NULL) {
+                memset(slot[k], k, size);
+            }
+        }
+    }
+
+    for (k = 0; k < SLOT_NUM; k++) {
+        sgl_free(slot[k]);
+    }
+    sgl_mm_cache_flush();
+
+    mm_lock();
+    bad += err;
+    mm_unlock();
+    return NULL;
+}
+
+
+/**
+ * @brief  run workers and measure the time
+ * @param  num  number of threads
+ * @return time in milliseconds
+ */
+static double run(int num)
+{
+    pthread_t thread[THREAD_MAX];
+    struct timespec start, end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long i = 0; i < num; i++) {
+        pthread_create(&thread[i], NULL, worker, (void*)i);
+    }
+    for (int i = 0; i < num; i++) {
+        pthread_join(thread[i], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6;
+}
+
+
+int main(void)
+{
+    double lock_time, cache_time;
+    size_t base, leak;
+
+    sgl_mm_init(pool, sizeof(pool));
+    base = sgl_mm_get_monitor().used_size;
+
+    printf("%d iterations of malloc or free per thread\n", ITER_NUM);
+    for (int num = 1; num <= THREAD_MAX; num *= 2) {
+        /* no thread has cache, every allocation takes the lock */
+        sgl_mm_lock_register(mm_lock, mm_unlock, NULL);
+        lock_time = run(num);
+
+        sgl_mm_lock_register(mm_lock, mm_unlock, mm_thread_id);
+        cache_time = run(num);
+
+        leak = sgl_mm_get_monitor().used_size - base;
+        printf("threads %d: lock only %.1f ms, thread cache %.1f ms, leak %d bytes\n",
+               num, lock_time, cache_time, (int)leak);
+    }
+
+    if (bad != 0) {
+        printf("mm_thread_bench: %d corrupted blocks\n", bad);
+        return 1;
+    }
+
+    return 0;
+}
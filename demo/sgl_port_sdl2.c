@@ -145,6 +145,42 @@ static sgl_color_t panel_buffer0[CONFIG_SGL_PANEL_WIDTH * CONFIG_SGL_PANEL_BUFFE
 static sgl_color_t panel_buffer1[CONFIG_SGL_PANEL_WIDTH * CONFIG_SGL_PANEL_BUFFER_LINE] = {0};
 
 
+#if (CONFIG_SGL_EXTERNAL_PIXMAP)
+/* file-backed stand-in of external flash, every read has an artificial latency */
+#define  CONFIG_SGL_PANEL_FLASH_FILE    "flash.bin"
+#define  CONFIG_SGL_PANEL_FLASH_DELAY   1
+
+static FILE *flash_file = NULL;
+
+static int flash_read(size_t addr, uint8_t *buf, uint32_t len)
+{
+    size_t n;
+
+    SDL_Delay(CONFIG_SGL_PANEL_FLASH_DELAY);
+
+    if (flash_file == NULL || fseek(flash_file, (long)addr, SEEK_SET) != 0) {
+        memset(buf, 0, len);
+        return -1;
+    }
+
+    n = fread(buf, 1, len, flash_file);
+    if (n < len) {
+        if (ferror(flash_file)) {
+            SGL_LOG_ERROR("SGL SDL2 read %s failed at %d", CONFIG_SGL_PANEL_FLASH_FILE, (int)addr);
+            clearerr(flash_file);
+            memset(buf, 0, len);
+            return -1;
+        }
+
+        /* the block out of file is filled with zero */
+        memset(buf + n, 0, len - n);
+    }
+
+    return 0;
+}
+#endif
+
+
 void log_stdout(const char *str)
 {
     printf(str);
@@ -168,6 +204,14 @@ sgl_port_sdl2_t* sgl_port_sdl2_init(void)
     sgl_logdev_register(log_stdout);
     sgl_fbdev_register(&fb_dev);
 
+#if (CONFIG_SGL_EXTERNAL_PIXMAP)
+    flash_file = fopen(CONFIG_SGL_PANEL_FLASH_FILE, "rb");
+    if (flash_file == NULL) {
+        SGL_LOG_WARN("SGL SDL2 open %s failed", CONFIG_SGL_PANEL_FLASH_FILE);
+    }
+    sgl_pixmap_read_register(flash_read);
+#endif
+
     /* init sgl */
     sgl_init();
 
@@ -215,4 +259,10 @@ void sgl_port_sdl2_deinit(sgl_port_sdl2_t* sdl2_dev)
     SDL_RemoveTimer(sdl2_dev->anim_systick);
     SDL_DestroyWindow(sdl2_dev->m_window);
     SDL_DestroyRenderer(m_renderer);
+
+#if (CONFIG_SGL_EXTERNAL_PIXMAP)
+    if (flash_file != NULL) {
+        fclose(flash_file);
+    }
+#endif
 }
@@ -1223,6 +1223,10 @@ static const sgl_font_unicode_t consolas24_unicode[] = {
     { .offset = 20013,   .len = 2,     .list = unicode_list_1, .tab_offset = 97, },
 };
 
+#if (CONFIG_SGL_FONT_INDEX)
+static sgl_font_index_t consolas24_index;
+#endif
+
 
 const sgl_font_t consolas24 = {
     .bitmap = glyph_bitmap,
@@ -1233,6 +1237,9 @@ const sgl_font_t consolas24 = {
     .bpp = 4,
     .unicode = consolas24_unicode,
     .unicode_num = 2,  
+#if (CONFIG_SGL_FONT_INDEX)
+    .index = &consolas24_index,
+#endif
 };
 
 #endif /* !CONFIG_SGL_FONT_CONSOLAS24*/
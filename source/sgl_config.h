@@ -1,12 +1,35 @@
 #ifndef __SGL_CONFIG_H__
 #define __SGL_CONFIG_H__ 
 
+/* the options can be overridden by the build, such as -DCONFIG_SGL_FONT_COMPRESSED=1 */
+
+#ifndef CONFIG_SGL_FBDEV_PIXEL_DEPTH
 #define  CONFIG_SGL_FBDEV_PIXEL_DEPTH           (16)
+#endif
+
+#ifndef CONFIG_SGL_SYSTICK_MS
 #define  CONFIG_SGL_SYSTICK_MS                  (10)
+#endif
+
+#ifndef CONFIG_SGL_HEAP_SIZE
 #define  CONFIG_SGL_HEAP_SIZE                   (10240)
+#endif
+
+#ifndef CONFIG_SGL_DEBUG
 #define  CONFIG_SGL_DEBUG                       (1)
+#endif
+
+#ifndef CONFIG_SGL_FONT_COMPRESSED
 #define  CONFIG_SGL_FONT_COMPRESSED             (0)
+#endif
+
+#ifndef CONFIG_SGL_FONT_SMALL_TABLE
 #define  CONFIG_SGL_FONT_SMALL_TABLE            (1)
+#endif
+
+#ifndef CONFIG_SGL_FONT_CONSOLAS24
 #define  CONFIG_SGL_FONT_CONSOLAS24             (1)
+#endif
+
 
 #endif
@@ -807,6 +807,151 @@ int sgl_fbdev_register(sgl_fbinfo_t *fbinfo)
 }
 
 
+#if (CONFIG_SGL_EXTERNAL_PIXMAP)
+/**
+ * @brief get a block of external memory from cache, the least recently used block is replaced
+ * @param cache pointer to pixmap cache
+ * @param block block number of external memory
+ * @return pointer to data of block
+ */
+static uint8_t* pixmap_cache_get_block(sgl_pixmap_cache_t *cache, uint32_t block)
+{
+    uint32_t victim = 0;
+
+    cache->clock ++;
+
+    for (uint32_t i = 0; i < CONFIG_SGL_PIXMAP_CACHE_BLOCK_NUM; i++) {
+        if (cache->tag[i] == block + 1) {
+            cache->stamp[i] = cache->clock;
+            return cache->block[i];
+        }
+
+        if (cache->tag[i] == 0 || cache->stamp[i] < cache->stamp[victim]) {
+            victim = i;
+        }
+    }
+
+    cache->tag[victim] = 0;
+    if (cache->read(block * CONFIG_SGL_PIXMAP_CACHE_BLOCK_SIZE, cache->block[victim], CONFIG_SGL_PIXMAP_CACHE_BLOCK_SIZE) != 0) {
+        return NULL;
+    }
+
+    cache->tag[victim] = block + 1;
+    cache->stamp[victim] = cache->clock;
+    return cache->block[victim];
+}
+
+
+/**
+ * @brief read external pixmap memory through block cache
+ * @param addr address of external memory
+ * @param buf buffer to store data
+ * @param len bytes of data
+ * @return int, 0 means successful, -1 means failed
+ */
+int sgl_pixmap_cache_read(size_t addr, uint8_t *buf, uint32_t len)
+{
+    sgl_pixmap_cache_t *cache = &sgl_system.pixmap_cache;
+    uint32_t offset, n;
+    uint8_t *data;
+
+    if (unlikely(cache->read == NULL)) {
+        SGL_LOG_ERROR("sgl_pixmap_cache_read: read callback is not registered");
+        return -1;
+    }
+
+    while (len > 0) {
+        offset = addr % CONFIG_SGL_PIXMAP_CACHE_BLOCK_SIZE;
+        n = sgl_min(len, CONFIG_SGL_PIXMAP_CACHE_BLOCK_SIZE - offset);
+
+        data = pixmap_cache_get_block(cache, addr / CONFIG_SGL_PIXMAP_CACHE_BLOCK_SIZE);
+        if (data == NULL) {
+            SGL_LOG_ERROR("sgl_pixmap_cache_read: read 0x%x failed", addr);
+            return -1;
+        }
+
+        memcpy(buf, data + offset, n);
+        addr += n;
+        buf += n;
+        len -= n;
+    }
+
+    return 0;
+}
+
+
+/**
+ * @brief record the row segment of external pixmap that is read in current band, the same
+ *        columns of the rows in next band will be prefetched after current band is flushed
+ * @param pixmap pointer to pixmap
+ * @param addr address of row segment
+ * @param len bytes of row segment
+ * @return none
+ */
+void sgl_pixmap_cache_hint(const sgl_pixmap_t *pixmap, size_t addr, uint32_t len)
+{
+    sgl_pixmap_cache_t *cache = &sgl_system.pixmap_cache;
+    uint8_t i;
+
+    for (i = 0; i < cache->hint_num; i++) {
+        if (cache->hint[i].pixmap == pixmap) {
+            break;
+        }
+    }
+
+    if (i == cache->hint_num) {
+        if (cache->hint_num == SGL_PIXMAP_PREFETCH_MAX) {
+            return;
+        }
+        cache->hint_num ++;
+    }
+
+    cache->hint[i].pixmap = pixmap;
+    cache->hint[i].addr = addr;
+    cache->hint[i].len = len;
+}
+
+
+/**
+ * @brief prefetch the row segments of external pixmaps for next band
+ * @param rows number of rows of next band
+ * @return none
+ * @note the prefetched blocks are limited by the cache size, so that they are not replaced
+ *       by each other before next band is drawn
+ */
+static void pixmap_cache_prefetch(int16_t rows)
+{
+    sgl_pixmap_cache_t *cache = &sgl_system.pixmap_cache;
+    uint32_t budget = CONFIG_SGL_PIXMAP_CACHE_BLOCK_NUM;
+    uint32_t first, last, stride;
+    size_t addr, end;
+
+    for (uint8_t i = 0; i < cache->hint_num && budget > 0; i++) {
+        stride = cache->hint[i].pixmap->width * sgl_pixmal_get_bits(cache->hint[i].pixmap);
+        end = cache->hint[i].pixmap->bitmap.addr + cache->hint[i].pixmap->height * stride;
+        addr = cache->hint[i].addr;
+
+        for (int16_t r = 0; r < rows && budget > 0; r++) {
+            addr += stride;
+            if (addr + cache->hint[i].len > end) {
+                break;
+            }
+
+            first = addr / CONFIG_SGL_PIXMAP_CACHE_BLOCK_SIZE;
+            last = (addr + cache->hint[i].len - 1) / CONFIG_SGL_PIXMAP_CACHE_BLOCK_SIZE;
+            for (uint32_t b = first; b <= last && budget > 0; b++, budget--) {
+                if (pixmap_cache_get_block(cache, b) == NULL) {
+                    budget = 0;
+                }
+            }
+        }
+    }
+
+    cache->hint_num = 0;
+}
+#endif // !CONFIG_SGL_EXTERNAL_PIXMAP
+
+
 /**
  * @brief get pixmap format bits
  * @param pixmap pointer to pixmap
@@ -829,6 +974,7 @@ uint8_t sgl_pixmal_get_bits(const sgl_pixmap_t *pixmap)
     case SGL_PIXMAP_FMT_RGB888:
     case SGL_PIXMAP_FMT_RLE_RGB888:
         bits = 3; break;
+    case SGL_PIXMAP_FMT_RGBA8888:
     case SGL_PIXMAP_FMT_RLE_RGBA8888:
         bits = 4; break;
     default:
@@ -839,6 +985,184 @@ uint8_t sgl_pixmal_get_bits(const sgl_pixmap_t *pixmap)
 }
 
 
+/**
+ * @brief calculate the bounding box of object subtree
+ * @param obj point to object
+ * @return union of draw area of object and bounding box of its children
+ */
+static inline sgl_area_t obj_bbox_calc(sgl_obj_t *obj)
+{
+    sgl_area_t bbox = sgl_obj_get_draw_area(obj);
+
+    for (sgl_obj_t *child = obj->child; child != NULL; child = child->sibling) {
+        sgl_area_selfmerge(&bbox, &child->bbox);
+    }
+
+    return bbox;
+}
+
+
+/**
+ * @brief update the bounding box of object subtree, and its parents if it is changed
+ * @param obj point to object
+ * @return none
+ * @note the bounding box is the union of draw area of object and all its descendants,
+ *       it should be called after the coords or draw extension of object is changed
+ */
+void sgl_obj_update_bbox(sgl_obj_t *obj)
+{
+    SGL_ASSERT(obj != NULL);
+    sgl_area_t bbox;
+
+    while (1) {
+        bbox = obj_bbox_calc(obj);
+        if (bbox.x1 == obj->bbox.x1 && bbox.y1 == obj->bbox.y1 && bbox.x2 == obj->bbox.x2 && bbox.y2 == obj->bbox.y2) {
+            return;
+        }
+
+        obj->bbox = bbox;
+
+        /* the parent of page is itself */
+        if (obj->parent == NULL || obj->parent == obj) {
+            return;
+        }
+        obj = obj->parent;
+    }
+}
+
+
+/**
+ * @brief unlink object from sibling list of its parent
+ * @param obj point to object
+ * @return none
+ */
+static inline void obj_list_unlink(sgl_obj_t *obj)
+{
+    sgl_obj_t *parent = obj->parent;
+
+    if (obj->prev != NULL) {
+        obj->prev->sibling = obj->sibling;
+    }
+    else {
+        parent->child = obj->sibling;
+    }
+
+    if (obj->sibling != NULL) {
+        obj->sibling->prev = obj->prev;
+    }
+    else {
+        parent->tail = obj->prev;
+    }
+
+    obj->prev = NULL;
+    obj->sibling = NULL;
+}
+
+
+/**
+ * @brief insert object into sibling list of parent
+ * @param parent point to parent object
+ * @param obj point to object
+ * @param next the sibling that object is inserted before, NULL means object is appended
+ * @return none
+ */
+static inline void obj_list_insert(sgl_obj_t *parent, sgl_obj_t *obj, sgl_obj_t *next)
+{
+    obj->prev = next != NULL ? next->prev : parent->tail;
+    obj->sibling = next;
+
+    if (obj->prev != NULL) {
+        obj->prev->sibling = obj;
+    }
+    else {
+        parent->child = obj;
+    }
+
+    if (next != NULL) {
+        next->prev = obj;
+    }
+    else {
+        parent->tail = obj;
+    }
+}
+
+
+/**
+ * @brief get next object of subtree in pre-order, the children of object are skipped
+ * @param obj point to object
+ * @param root root of subtree
+ * @return next object, NULL means the subtree is done
+ * @note the traversal follows the sibling and parent links, so it needs no stack
+ */
+static inline sgl_obj_t* obj_next_skip(sgl_obj_t *obj, sgl_obj_t *root)
+{
+    while (obj != root) {
+        if (obj->sibling != NULL) {
+            return obj->sibling;
+        }
+        obj = obj->parent;
+    }
+
+    return NULL;
+}
+
+
+/**
+ * @brief get next object of subtree in pre-order
+ * @param obj point to object
+ * @param root root of subtree
+ * @return next object, NULL means the subtree is done
+ */
+static inline sgl_obj_t* obj_next(sgl_obj_t *obj, sgl_obj_t *root)
+{
+    if (obj->child != NULL) {
+        return obj->child;
+    }
+
+    return obj_next_skip(obj, root);
+}
+
+
+/**
+ * @brief get next object of subtree in pre-order with its clip, the children of object are skipped
+ * @param obj point to object
+ * @param root root of subtree
+ * @param base clip of root
+ * @param clip [in][out] clip of object, it's the clip of next object on return
+ * @return next object, NULL means the subtree is done
+ * @note the sibling has the same clip, the clip is rebuilt from the coords of ancestors only
+ *       if the traversal goes up, the empty clip is made by sgl_area_init()
+ */
+static inline sgl_obj_t* obj_next_clip(sgl_obj_t *obj, sgl_obj_t *root, sgl_area_t *base, sgl_area_t *clip)
+{
+    sgl_obj_t *parent;
+    bool up = false;
+
+    while (obj != root) {
+        if (obj->sibling != NULL) {
+            if (up) {
+                *clip = *base;
+                for (parent = obj->parent; ; parent = parent->parent) {
+                    if (!sgl_area_selfclip(clip, &parent->coords)) {
+                        sgl_area_init(clip);
+                        break;
+                    }
+
+                    if (parent == root) {
+                        break;
+                    }
+                }
+            }
+            return obj->sibling;
+        }
+        obj = obj->parent;
+        up = true;
+    }
+
+    return NULL;
+}
+
+
 /**
  * @brief add object to parent
  * @param parent: pointer of parent object
@@ -848,19 +1172,22 @@ uint8_t sgl_pixmal_get_bits(const sgl_pixmap_t *pixmap)
 void sgl_obj_add_child(sgl_obj_t *parent, sgl_obj_t *obj)
 {
     SGL_ASSERT(parent != NULL && obj != NULL);
-    sgl_obj_t *tail = parent->child;
+    sgl_area_t *bbox = &obj->bbox;
 
-    if (parent->child) {
-        while (tail->sibling != NULL) {
-            tail = tail->sibling;
-        };
-        tail->sibling = obj;
-    }
-    else {
-        parent->child = obj;
-    }
+    obj_list_insert(parent, obj, NULL);
 
     obj->parent = parent;
+    obj->bbox = obj_bbox_calc(obj);
+
+    /* the bounding box of parents only grows, stop at the first one that contains it */
+    while (bbox->x1 < parent->bbox.x1 || bbox->y1 < parent->bbox.y1 || bbox->x2 > parent->bbox.x2 || bbox->y2 > parent->bbox.y2) {
+        sgl_area_selfmerge(&parent->bbox, bbox);
+        if (parent->parent == NULL || parent->parent == parent) {
+            break;
+        }
+        bbox = &parent->bbox;
+        parent = parent->parent;
+    }
 }
 
 
@@ -872,22 +1199,14 @@ void sgl_obj_add_child(sgl_obj_t *parent, sgl_obj_t *obj)
 void sgl_obj_remove(sgl_obj_t *obj)
 {
     SGL_ASSERT(obj != NULL);
-
     sgl_obj_t *parent = obj->parent;
-    sgl_obj_t *pos = NULL;
 
-    if (parent->child != obj) {
-        pos = parent->child;
-        while (pos->sibling != obj) {
-            pos = pos->sibling;
-        }
-        pos->sibling = obj->sibling;
-    }
-    else {
-        parent->child = obj->sibling;
-    }
+    obj_list_unlink(obj);
 
-    obj->sibling = NULL;
+    /* the bounding box of parent shrinks only if the object is on its edge */
+    if (obj->bbox.x1 == parent->bbox.x1 || obj->bbox.y1 == parent->bbox.y1 || obj->bbox.x2 == parent->bbox.x2 || obj->bbox.y2 == parent->bbox.y2) {
+        sgl_obj_update_bbox(parent);
+    }
 }
 
 
@@ -901,32 +1220,23 @@ void sgl_obj_remove(sgl_obj_t *obj)
 void sgl_obj_move_child_pos(sgl_obj_t *obj, int16_t ofs_x, int16_t ofs_y)
 {
     SGL_ASSERT(obj != NULL);
-	sgl_obj_t *stack[SGL_OBJ_DEPTH_MAX];
-    int top = 0;
-
-    if (obj->child == NULL) {
-        return;
-    }
-    stack[top++] = obj->child;
+    sgl_obj_t *node;
 
-    while (top > 0) {
-		SGL_ASSERT(top < SGL_OBJ_DEPTH_MAX);
-		obj = stack[--top];
-
-        obj->dirty = 1;
-        obj->coords.x1 += ofs_x;
-        obj->coords.x2 += ofs_x;
-        obj->coords.y1 += ofs_y;
-        obj->coords.y2 += ofs_y;
-
-		if (obj->sibling != NULL) {
-			stack[top++] = obj->sibling;
-		}
+    for (node = obj->child; node != NULL; node = obj_next(node, obj)) {
+        node->dirty = 1;
+        node->coords.x1 += ofs_x;
+        node->coords.x2 += ofs_x;
+        node->coords.y1 += ofs_y;
+        node->coords.y2 += ofs_y;
 
-		if (obj->child != NULL) {
-			stack[top++] = obj->child;
-		}
+        /* the whole subtree is moved, so its bounding box is moved too */
+        node->bbox.x1 += ofs_x;
+        node->bbox.x2 += ofs_x;
+        node->bbox.y1 += ofs_y;
+        node->bbox.y2 += ofs_y;
     }
+
+    sgl_obj_update_bbox(obj);
 }
 
 
@@ -967,6 +1277,7 @@ void sgl_obj_size_zoom(sgl_obj_t *obj, int16_t zoom)
     obj->coords.x2 += zoom;
     obj->coords.y1 -= zoom;
     obj->coords.y2 += zoom;
+    sgl_obj_update_bbox(obj);
 }
 
 
@@ -979,34 +1290,18 @@ void sgl_obj_size_zoom(sgl_obj_t *obj, int16_t zoom)
 void sgl_obj_move_up(sgl_obj_t *obj)
 {
     SGL_ASSERT(obj != NULL);
-    sgl_obj_t *parent = obj->parent;
-    sgl_obj_t *prev = NULL;
-    sgl_obj_t *next = NULL;
+    sgl_obj_t *next = obj->sibling;
 
     /* if the object is the last child, do not move it */
-    if (obj->sibling == NULL) {
-        return;
-    }
-    else if (parent->child == obj) {
-        parent->child = obj->sibling;
-        obj->sibling = obj->sibling->sibling;
-        /* mark object as dirty */
-        sgl_obj_set_dirty(obj);
+    if (next == NULL) {
         return;
     }
 
     /* move the object to its next sibling */
-    sgl_obj_for_each_child(prev, parent) {
-        if (prev->sibling == obj) {
-            next = obj->sibling;
-            obj->sibling = next->sibling;
-            prev->sibling = next;
-            next->sibling = obj;
-            /* mark object as dirty */
-            sgl_obj_set_dirty(obj);
-            return;
-        }
-    }
+    obj_list_unlink(obj);
+    obj_list_insert(obj->parent, obj, next->sibling);
+    /* mark object as dirty */
+    sgl_obj_set_dirty(obj);
 }
 
 
@@ -1019,36 +1314,18 @@ void sgl_obj_move_up(sgl_obj_t *obj)
 void sgl_obj_move_down(sgl_obj_t *obj)
 {
     SGL_ASSERT(obj != NULL);
-    sgl_obj_t *parent = obj->parent;
-    sgl_obj_t *prev = NULL;
-    sgl_obj_t *gprev = NULL;
+    sgl_obj_t *prev = obj->prev;
 
     /* if the object is the first child, do not move it */
-    if (parent->child == obj || obj->sibling == NULL) {
-        return;
-    }
-    else if (parent->child->sibling == obj) {
-        parent->child->sibling = obj->sibling;
-        obj->sibling = parent->child;
-        parent->child = obj;
-        /* mark object as dirty */
-        sgl_obj_set_dirty(obj);
+    if (prev == NULL) {
         return;
     }
 
     /* move the object to its prev sibling */
-    sgl_obj_for_each_child(gprev, parent) {
-        prev = gprev->sibling;
-
-        if (prev->sibling == obj) {
-            prev->sibling = obj->sibling;
-            gprev->sibling = obj;
-            obj->sibling = prev;
-            /* mark object as dirty */
-            sgl_obj_set_dirty(obj);
-            return;
-        }
-    }
+    obj_list_unlink(obj);
+    obj_list_insert(obj->parent, obj, prev);
+    /* mark object as dirty */
+    sgl_obj_set_dirty(obj);
 }
 
 
@@ -1062,39 +1339,13 @@ void sgl_obj_move_top(sgl_obj_t *obj)
 {
     SGL_ASSERT(obj != NULL && obj->parent != NULL);
 
-    sgl_obj_t *parent = obj->parent;
-    sgl_obj_t *prev = NULL, *curr = parent->child, *last = NULL;
-
     /* if the object is the last child, do not move it */
     if (obj->sibling == NULL) {
         return;
     }
 
-    while (curr != NULL && curr != obj) {
-        prev = curr;
-        curr = curr->sibling;
-    }
-
-    if (prev == NULL) {
-        parent->child = obj->sibling;
-    }
-    else {
-        prev->sibling = obj->sibling;
-    }
-
-    last = parent->child;
-    if (last == NULL) {
-        parent->child = obj;
-        obj->sibling = NULL;
-    }
-    else {
-        while (last->sibling != NULL) {
-            last = last->sibling;
-        }
-        last->sibling = obj;
-        obj->sibling = NULL;
-    }
-
+    obj_list_unlink(obj);
+    obj_list_insert(obj->parent, obj, NULL);
     sgl_obj_set_dirty(obj);
 }
 
@@ -1108,23 +1359,14 @@ void sgl_obj_move_top(sgl_obj_t *obj)
 void sgl_obj_move_bottom(sgl_obj_t *obj)
 {
     SGL_ASSERT(obj != NULL);
-    sgl_obj_t *parent = obj->parent;
-    sgl_obj_t *prev = NULL;
 
     /* if the object is the first child, do not move it */
-    if (parent->child == obj) {
+    if (obj->prev == NULL) {
         return;
     }
 
-    sgl_obj_for_each_child(prev, parent) {
-        if (prev->sibling == obj) {
-            break;
-        }
-    }
-
-    prev->sibling = obj->sibling;
-    obj->sibling = parent->child;
-    parent->child = obj;
+    obj_list_unlink(obj);
+    obj_list_insert(obj->parent, obj, obj->parent->child);
     /* mark object as dirty */
     sgl_obj_set_dirty(obj);
 }
@@ -1159,28 +1401,15 @@ void sgl_obj_set_radius(sgl_obj_t *obj, size_t radius)
  */
 void sgl_obj_print_name(sgl_obj_t *obj)
 {
-    int top = 0;
-	sgl_obj_t *stack[SGL_OBJ_DEPTH_MAX];
-    stack[top++] = obj;
+    sgl_obj_t *node;
 
-    while (top > 0) {
-		SGL_ASSERT(top < SGL_OBJ_DEPTH_MAX);
-		obj = stack[--top];
-
-        if (obj->name == NULL) {
+    for (node = obj; node != NULL; node = obj_next(node, obj)) {
+        if (node->name == NULL) {
             SGL_LOG_INFO("[OBJ NAME]: %s", "NULL");
         }
         else {
-            SGL_LOG_INFO("[OBJ NAME]: %s", obj->name);
+            SGL_LOG_INFO("[OBJ NAME]: %s", node->name);
         }
-
-		if (obj->sibling != NULL) {
-			stack[top++] = obj->sibling;
-		}
-
-		if (obj->child != NULL) {
-			stack[top++] = obj->child;
-		}
     }
 }
 
@@ -1250,9 +1479,7 @@ static sgl_page_t* sgl_page_create(void)
         return NULL;
     }
 
-    /* clear the page all fields */
-    memset(page, 0, sizeof(sgl_page_t));
-
+    /* the page all fields is cleared by sgl_malloc */
     sgl_obj_t *obj = &page->obj;
 
     if (sgl_system.fbdev.fbinfo.buffer[0] == NULL) {
@@ -1274,6 +1501,7 @@ static sgl_page_t* sgl_page_create(void)
         .x2 = sgl_system.fbdev.fbinfo.xres - 1,
         .y2 = sgl_system.fbdev.fbinfo.yres - 1,
     };
+    obj->bbox = obj->coords;
 
     /* init child list */
     sgl_obj_node_init(&page->obj);
@@ -1307,7 +1535,7 @@ sgl_obj_t* sgl_obj_create(sgl_obj_t *parent)
         return obj;
     }
     else {
-        obj = (sgl_obj_t*)sgl_malloc(sizeof(sgl_obj_t));
+        obj = (sgl_obj_t*)sgl_obj_alloc(sizeof(sgl_obj_t), parent);
         if (obj == NULL) {
             SGL_LOG_ERROR("malloc failed");
             return NULL;
@@ -1316,6 +1544,7 @@ sgl_obj_t* sgl_obj_create(sgl_obj_t *parent)
         obj->coords = parent->coords;
         obj->parent = parent;
         obj->construct_fn = NULL;
+        obj->destroy_fn = NULL;
         obj->dirty = 1;
 
         /* init node */
@@ -1351,6 +1580,7 @@ int sgl_init(void)
 
     /* init memory pool */
     sgl_mm_init(sgl_system.mem_pool, sizeof(sgl_system.mem_pool));
+    sgl_frame_arena_init(sgl_system.frame_arena, sizeof(sgl_system.frame_arena));
 
     /* initialize current context */
     sgl_system.fbdev.active = NULL;
@@ -1367,7 +1597,7 @@ int sgl_init(void)
 
     /* if the rotation is not 0 or 180, we need to alloc a buffer for rotation */
 #if (CONFIG_SGL_FBDEV_ROTATION != 0)
-    sgl_system.rotation = (sgl_color_t*)sgl_malloc(sgl_system.fbdev.fbinfo.buffer_size * sizeof(sgl_color_t));
+    sgl_system.rotation = (sgl_color_t*)sgl_malloc_hint(sgl_system.fbdev.fbinfo.buffer_size * sizeof(sgl_color_t), SGL_MM_HEAP_FAST);
     if (sgl_system.rotation == NULL) {
         SGL_LOG_ERROR("sgl_init: alloc rotation buffer failed");
         return -1;
@@ -1517,6 +1747,7 @@ int sgl_obj_init(sgl_obj_t *obj, sgl_obj_t *parent)
     obj->coords = parent->coords;
     obj->parent = parent;
     obj->construct_fn = NULL;
+    obj->destroy_fn = NULL;
     obj->dirty = 1;
 
     /* add the child into parent's child list */
@@ -1526,32 +1757,208 @@ int sgl_obj_init(sgl_obj_t *obj, sgl_obj_t *parent)
 }
 
 
+#if (CONFIG_SGL_PAGE_ARENA_SIZE)
+/* header of arena chunk that keeps the link to next chunk */
+#define  PAGE_ARENA_HEAD                         SGL_MM_ARENA_ROUND(sizeof(void*))
+
+
+/**
+ * @brief  alloc memory from the arena of page, the object that is deleted alone in same class
+ *         is reused first, otherwise it's bumped, a new chunk is added if it is full
+ * @param  page: page that owns the arena
+ * @param  size: request size of memory
+ * @param  cls: slab class of size, -1 means memory is not reused
+ * @retval pointer of memory that is set to zero, NULL means out of memory
+ */
+static void* page_arena_alloc(sgl_page_t *page, size_t size, int cls)
+{
+    size_t chunk_size;
+    uint8_t *chunk, *p;
+
+    if (cls >= 0) {
+        /* the object is bumped in the size of class, so it fits all objects of class */
+        size = sgl_slab_get_monitor(cls).obj_size;
+        p = page->arena_free[cls];
+        if (p != NULL) {
+            page->arena_free[cls] = *(void**)p;
+            memset(p, 0, size);
+            return p;
+        }
+    }
+
+    size = SGL_MM_ARENA_ROUND(size);
+
+    if (page->arena == NULL || page->arena_end - page->arena_pos < size) {
+        /* the rest of old chunk is wasted, it's released with page */
+        chunk_size = sgl_max(CONFIG_SGL_PAGE_ARENA_SIZE, size + PAGE_ARENA_HEAD);
+        chunk = sgl_malloc_hint(chunk_size, SGL_MM_HEAP_FAST);
+        if (chunk == NULL) {
+            return NULL;
+        }
+
+        *(uint8_t**)chunk = page->arena;
+        page->arena = chunk;
+        page->arena_pos = PAGE_ARENA_HEAD;
+        page->arena_end = chunk_size;
+    }
+
+    p = page->arena + page->arena_pos;
+    page->arena_pos += size;
+    return p;
+}
+
+
+/**
+ * @brief  release all chunks of the arena of page
+ * @param  page: page that owns the arena
+ * @retval none
+ * @note   all objects in the arena should be released before
+ */
+static void page_arena_release(sgl_page_t *page)
+{
+    uint8_t *next;
+
+    while (page->arena != NULL) {
+        next = *(uint8_t**)page->arena;
+        sgl_free(page->arena);
+        page->arena = next;
+    }
+
+    page->arena_pos = page->arena_end = 0;
+    memset(page->arena_free, 0, sizeof(page->arena_free));
+}
+
+
+/**
+ * @brief  give the object back to the arena of its page, it's reused by the objects of same class
+ * @param  obj: object that is deleted alone
+ * @retval none
+ * @note   the parent of object should be valid, the storage is kept if page is not found
+ */
+static void page_arena_free(sgl_obj_t *obj)
+{
+    sgl_obj_t *page = obj->parent;
+    int cls = obj->slab - 1;
+
+    while (page != NULL && !page->page) {
+        page = page->parent;
+    }
+
+    if (page != NULL) {
+        *(void**)obj = ((sgl_page_t*)page)->arena_free[cls];
+        ((sgl_page_t*)page)->arena_free[cls] = obj;
+    }
+}
+#endif
+
+
+/**
+ * @brief  alloc memory of object from the slab class of its size, or from the arena of
+ *         its page if CONFIG_SGL_PAGE_ARENA_SIZE is set
+ * @param  size: size of object struct, the struct should begin with sgl_obj_t
+ * @param  parent: parent of object, NULL means active page
+ * @retval pointer of object that is set to zero, NULL means out of memory
+ * @note   the object should be released by sgl_obj_free(), if all slab classes are
+ *         used by other sizes, the object is allocated from heap. the object in page
+ *         arena that is freed alone is reused by its page, if its size has no slab class,
+ *         its storage is kept until page is deleted
+ */
+void* sgl_obj_alloc(size_t size, sgl_obj_t *parent)
+{
+#if (CONFIG_SGL_PAGE_ARENA_SIZE)
+    sgl_obj_t *page = (parent == NULL) ? sgl_screen_act() : parent;
+
+    while (page != NULL && !page->page) {
+        page = page->parent;
+    }
+
+    if (page != NULL) {
+        int cls = sgl_slab_get_class(size);
+        sgl_obj_t *obj = (sgl_obj_t*)page_arena_alloc((sgl_page_t*)page, size, cls);
+        if (obj != NULL) {
+            /* the class of object in arena is kept for reuse, it's not from slab */
+            obj->nofree = 1;
+            obj->slab = cls + 1;
+        }
+        return obj;
+    }
+#else
+    SGL_UNUSED(parent);
+#endif
+
+    int cls = sgl_slab_get_class(size);
+    sgl_obj_t *obj;
+
+    if (cls < 0) {
+        obj = (sgl_obj_t*)sgl_malloc(size);
+    }
+    else {
+        obj = (sgl_obj_t*)sgl_slab_alloc(cls);
+    }
+
+    if (obj != NULL) {
+        obj->slab = cls + 1;
+    }
+
+    return obj;
+}
+
+
 /**
  * @brief  free an object
  * @param  obj: object to free
  * @retval none
- * @note this function will free all the children of the object
+ * @note this function will free all the children of the object, the object whose
+ *       nofree flag is set is released but its storage is not freed, the siblings of
+ *       the object are not freed
  */
 void sgl_obj_free(sgl_obj_t *obj)
 {
     SGL_ASSERT(obj != NULL);
-	sgl_obj_t *stack[SGL_OBJ_DEPTH_MAX];
-    int top = 0;
-    stack[top++] = obj;
+    sgl_obj_t *node = obj, *next;
 
-    while (top > 0) {
-		SGL_ASSERT(top < SGL_OBJ_DEPTH_MAX);
-		obj = stack[--top];
+    /* the children are freed before their parent in post-order, so the parent link is
+     * still valid when the traversal goes up, the object itself is freed at last
+     */
+    while (node->child != NULL) {
+        node = node->child;
+    }
 
-		if (obj->sibling != NULL) {
-			stack[top++] = obj->sibling;
-		}
+    while (node != NULL) {
+        if (node == obj) {
+            next = NULL;
+        }
+        else if (node->sibling != NULL) {
+            next = node->sibling;
+            while (next->child != NULL) {
+                next = next->child;
+            }
+        }
+        else {
+            next = node->parent;
+        }
 
-		if (obj->child != NULL) {
-			stack[top++] = obj->child;
-		}
+        /* release the private resource of object */
+        if (node->destroy_fn != NULL) {
+            node->destroy_fn(node);
+        }
 
-        sgl_free(obj);
+        /* the storage of object is owned by user or page arena */
+        if (!node->nofree) {
+            if (node->slab) {
+                sgl_slab_free(node->slab - 1, node);
+            }
+            else {
+                sgl_free(node);
+            }
+        }
+#if (CONFIG_SGL_PAGE_ARENA_SIZE)
+        else if (node->slab) {
+            page_arena_free(node);
+        }
+#endif
+
+        node = next;
     }
 }
 
@@ -1566,17 +1973,36 @@ void sgl_obj_free(sgl_obj_t *obj)
  */
 void sgl_obj_delete(sgl_obj_t *obj)
 {
+    sgl_obj_t *child, *n;
+
     if (obj == NULL || obj == sgl_screen_act()) {
         obj = sgl_screen_act();
         sgl_dirty_area_push(&obj->coords);
-        if (obj->child) {
-            sgl_obj_free(obj->child);
+        sgl_obj_for_each_child_safe(child, n, obj) {
+            sgl_obj_free(child);
         }
         sgl_obj_node_init(obj);
+        sgl_obj_update_bbox(obj);
+#if (CONFIG_SGL_PAGE_ARENA_SIZE)
+        page_arena_release((sgl_page_t*)obj);
+#endif
+
+        /* all objects of page are unloaded, the memory that is still used is reported */
+        sgl_mm_report();
         return;
     }
     else if (obj->page == 1) {
+#if (CONFIG_SGL_PAGE_ARENA_SIZE)
+        /* the children are released before their storage, the arena is freed at once */
+        sgl_obj_for_each_child_safe(child, n, obj) {
+            sgl_obj_free(child);
+        }
+        obj->child = NULL;
+        obj->tail = NULL;
+        page_arena_release((sgl_page_t*)obj);
+#endif
         sgl_obj_free(obj);
+        sgl_mm_report();
         return;
     }
 
@@ -1585,41 +2011,250 @@ void sgl_obj_delete(sgl_obj_t *obj)
 }
 
 
+/* length of UTF-8 sequence indexed by the high 5 bits of lead byte, 0 means invalid lead byte */
+static const uint8_t utf8_seq_len[32] = {
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    0, 0, 0, 0, 0, 0, 0, 0, 2, 2, 2, 2, 3, 3, 4, 0,
+};
+
+static const uint8_t utf8_lead_mask[5] = { 0x00, 0x7F, 0x1F, 0x0F, 0x07 };
+static const uint32_t utf8_min_unicode[5] = { 0, 0, 0x80, 0x800, 0x10000 };
+
+
 /**
  * @brief Convert UTF-8 string to Unicode
  * @param utf8_str Pointer to the UTF-8 string to be converted
  * @param p_unicode_buffer Pointer to the buffer where the converted Unicode will be stored
  * @return The number of bytes in the UTF-8 string
+ * @note invalid or truncated sequence is converted to SGL_UNICODE_REPLACEMENT and consumes one byte,
+ *       the decoder never reads over the end of string
  */
 uint32_t sgl_utf8_to_unicode(const char *utf8_str, uint32_t *p_unicode_buffer)
 {
-    int bytes = 0;
-    if (((uint8_t)(*utf8_str)) < 0x80) { // 1-byte/7-bit ASCII
-        bytes = 1;
-        *p_unicode_buffer = utf8_str[0];
+    const uint8_t *s = (const uint8_t*)utf8_str;
+    uint32_t len = utf8_seq_len[s[0] >> 3];
+    uint32_t unicode = s[0] & utf8_lead_mask[len];
+
+    if (likely(len == 1)) {
+        *p_unicode_buffer = unicode;
+        return 1;
     }
-    else if ((((uint8_t)(*utf8_str)) & 0xE0) == 0xC0) { // 2-byte
-        bytes = 2;
-        *p_unicode_buffer = (utf8_str[0] & 0x1F) << 6;
-        *p_unicode_buffer |= (utf8_str[1] & 0x3F);
+
+    /* the terminator is not a continuation byte, so a truncated sequence stops here */
+    for (uint32_t i = 1; i < len; i ++) {
+        if ((s[i] & 0xC0) != 0x80) {
+            goto invalid;
+        }
+        unicode = (unicode << 6) | (s[i] & 0x3F);
     }
-    else if ((((uint8_t)(*utf8_str)) & 0xF0) == 0xE0) { // 3-byte
-        bytes = 3;
-        *p_unicode_buffer = (utf8_str[0] & 0x0F) << 12;
-        *p_unicode_buffer |= (utf8_str[1] & 0x3F) << 6;
-        *p_unicode_buffer |= (utf8_str[2] & 0x3F);
+
+    /* reject invalid lead byte, overlong sequence, surrogate and out of range unicode */
+    if (unlikely(len == 0 || unicode < utf8_min_unicode[len] || unicode > 0x10FFFF || (unicode >= 0xD800 && unicode <= 0xDFFF))) {
+        goto invalid;
     }
-    else if ((((uint8_t)(*utf8_str)) & 0xF8) == 0xF0) { // 4-byte
-        bytes = 4;
-        *p_unicode_buffer = (utf8_str[0] & 0x07) << 18;
-        *p_unicode_buffer |= (utf8_str[2] & 0x3F) << 6;
-        *p_unicode_buffer |= (utf8_str[1] & 0x3F) << 12;
-        *p_unicode_buffer |= (utf8_str[3] & 0x3F);
+
+    *p_unicode_buffer = unicode;
+    return len;
+
+invalid:
+    *p_unicode_buffer = SGL_UNICODE_REPLACEMENT;
+    return 1;
+}
+
+
+#if (CONFIG_SGL_FONT_INDEX)
+/**
+ * @brief count the number of set bits
+ * @param x 32 bit value
+ * @return number of set bits
+ */
+static inline uint32_t sgl_popcount32(uint32_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcount(x);
+#else
+    x = x - ((x >> 1) & 0x55555555);
+    x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+    x = (x + (x >> 4)) & 0x0F0F0F0F;
+    return (x * 0x01010101) >> 24;
+#endif
+}
+
+
+/**
+ * @brief get the unicode and index in font table of a character in unicode part
+ * @param code unicode part of font
+ * @param i number of character in unicode part
+ * @param unicode [out] unicode of character
+ * @return index of character in font table
+ */
+static inline uint32_t font_unicode_part_get(const sgl_font_unicode_t *code, uint32_t i, uint32_t *unicode)
+{
+    *unicode = code->offset + (code->list == NULL ? i : code->list[i]);
+    return code->tab_offset + i;
+}
+
+
+/**
+ * @brief get rank of unicode in the index page
+ * @param page index page
+ * @param low low 8 bits of unicode
+ * @return rank of unicode, -1 means the unicode is not in page
+ */
+static inline int32_t font_index_page_rank(const sgl_font_index_page_t *page, uint32_t low)
+{
+    uint32_t word = page->bitmap[low >> 5];
+    uint32_t bit = low & 0x1F;
+
+    if ((word & (1u << bit)) == 0) {
+        return -1;
     }
-    return bytes;
+
+    return page->rank[low >> 5] + sgl_popcount32(word & ((1u << bit) - 1));
 }
 
 
+/**
+ * @brief build the unicode index of font
+ * @param font Pointer to the font structure
+ * @param index Pointer to the index of font
+ * @return int, 0 means successful, -1 means failed
+ * @note the index requires that the characters in the same page are continuous in font table,
+ *       otherwise the index is unavailable, and the unicode will be searched without index
+ */
+static int font_index_build(const sgl_font_t *font, sgl_font_index_t *index)
+{
+    const sgl_font_unicode_t *code = NULL;
+    uint32_t unicode = 0, ch_index = 0, low = 0;
+    uint32_t first = UINT32_MAX, last = 0, page_num = 0, slot_num = 0;
+    sgl_font_index_page_t *page = NULL;
+    int32_t rank = 0;
+
+    /* find the unicode pages range of font */
+    for (uint32_t i = 0; i < font->unicode_num; i++) {
+        code = &font->unicode[i];
+        for (uint32_t j = 0; j < code->len; j++) {
+            font_unicode_part_get(code, j, &unicode);
+            first = sgl_min(first, unicode >> 8);
+            last = sgl_max(last, unicode >> 8);
+        }
+    }
+
+    if (first > last || (last - first + 1) >= SGL_FONT_INDEX_EMPTY) {
+        return -1;
+    }
+
+    page_num = last - first + 1;
+    index->root = (uint16_t*)sgl_malloc_hint(page_num * sizeof(uint16_t), SGL_MM_HEAP_FAST);
+    if (index->root == NULL) {
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < page_num; i++) {
+        index->root[i] = SGL_FONT_INDEX_EMPTY;
+    }
+
+    /* allocate slot for every page that has characters */
+    for (uint32_t i = 0; i < font->unicode_num; i++) {
+        code = &font->unicode[i];
+        for (uint32_t j = 0; j < code->len; j++) {
+            font_unicode_part_get(code, j, &unicode);
+            if (index->root[(unicode >> 8) - first] == SGL_FONT_INDEX_EMPTY) {
+                index->root[(unicode >> 8) - first] = slot_num ++;
+            }
+        }
+    }
+
+    index->page = (sgl_font_index_page_t*)sgl_malloc_hint(slot_num * sizeof(sgl_font_index_page_t), SGL_MM_HEAP_FAST);
+    if (index->page == NULL) {
+        goto failed;
+    }
+
+    memset(index->page, 0, slot_num * sizeof(sgl_font_index_page_t));
+    for (uint32_t i = 0; i < slot_num; i++) {
+        index->page[i].base = SGL_FONT_INDEX_EMPTY;
+    }
+
+    /* set bitmap of pages, and then calculate the rank of each word */
+    for (uint32_t i = 0; i < font->unicode_num; i++) {
+        code = &font->unicode[i];
+        for (uint32_t j = 0; j < code->len; j++) {
+            font_unicode_part_get(code, j, &unicode);
+            page = &index->page[index->root[(unicode >> 8) - first]];
+            low = unicode & 0xFF;
+            page->bitmap[low >> 5] |= (1u << (low & 0x1F));
+        }
+    }
+
+    for (uint32_t i = 0; i < slot_num; i++) {
+        page = &index->page[i];
+        for (uint32_t k = 1; k < SGL_ARRAY_SIZE(page->bitmap); k++) {
+            page->rank[k] = page->rank[k - 1] + sgl_popcount32(page->bitmap[k - 1]);
+        }
+    }
+
+    /* the index of characters in a page must be continuous */
+    for (uint32_t i = 0; i < font->unicode_num; i++) {
+        code = &font->unicode[i];
+        for (uint32_t j = 0; j < code->len; j++) {
+            ch_index = font_unicode_part_get(code, j, &unicode);
+            page = &index->page[index->root[(unicode >> 8) - first]];
+            rank = font_index_page_rank(page, unicode & 0xFF);
+
+            if (page->base == SGL_FONT_INDEX_EMPTY && ch_index >= (uint32_t)rank) {
+                page->base = ch_index - rank;
+            }
+
+            if ((uint32_t)(page->base + rank) != ch_index) {
+                goto failed;
+            }
+        }
+    }
+
+    index->first = first;
+    index->page_num = page_num;
+    index->size = page_num * sizeof(uint16_t) + slot_num * sizeof(sgl_font_index_page_t);
+
+    SGL_LOG_INFO("font index: %d pages, %d bytes", slot_num, index->size);
+    return 0;
+
+failed:
+    if (index->page != NULL) {
+        sgl_free(index->page);
+        index->page = NULL;
+    }
+    sgl_free(index->root);
+    index->root = NULL;
+    return -1;
+}
+
+
+/**
+ * @brief search unicode in index of font
+ * @param index Pointer to the index of font
+ * @param unicode Unicode of the character to be searched
+ * @return Index of the character in the font table, -1 means not found
+ */
+static inline int32_t font_index_search(sgl_font_index_t *index, uint32_t unicode)
+{
+    uint32_t page = (unicode >> 8) - index->first;
+    int32_t rank;
+
+    if (page >= index->page_num || index->root[page] == SGL_FONT_INDEX_EMPTY) {
+        return -1;
+    }
+
+    const sgl_font_index_page_t *p = &index->page[index->root[page]];
+    rank = font_index_page_rank(p, unicode & 0xFF);
+    if (rank < 0) {
+        return -1;
+    }
+
+    return p->base + rank;
+}
+#endif // !CONFIG_SGL_FONT_INDEX
+
+
 /**
  * @brief Search for the index of a Unicode character in the font table
  * @param font Pointer to the font structure containing character data
@@ -1628,10 +2263,34 @@ uint32_t sgl_utf8_to_unicode(const char *utf8_str, uint32_t *p_unicode_buffer)
  */
 uint32_t sgl_search_unicode_ch_index(const sgl_font_t *font, uint32_t unicode)
 {
-    uint32_t left = 0, right = 0, mid = 0;
+    int32_t left = 0, right = 0, mid = 0;
     uint32_t target = unicode;
     const sgl_font_unicode_t *code = font->unicode;
 
+    /* fast path for ASCII, the first unicode part of font is always continuous */
+    if (likely(unicode < 0x80 && code->list == NULL && unicode >= code->offset && unicode - code->offset < code->len)) {
+        return unicode - code->offset + code->tab_offset;
+    }
+
+#if (CONFIG_SGL_FONT_INDEX)
+    sgl_font_index_t *index = font->index;
+
+    if (index != NULL) {
+        if (unlikely(index->status == SGL_FONT_INDEX_NONE)) {
+            index->status = font_index_build(font, index) == 0 ? SGL_FONT_INDEX_READY : SGL_FONT_INDEX_UNAVAILABLE;
+        }
+
+        if (likely(index->status == SGL_FONT_INDEX_READY)) {
+            int32_t ch_index = font_index_search(index, unicode);
+            if (ch_index < 0) {
+                SGL_LOG_WARN("sgl_search_unicode_ch_index: [0x%x]unicode not found in font table", unicode);
+                return 0;
+            }
+            return ch_index;
+        }
+    }
+#endif
+
     for (uint32_t i = 1; i < font->unicode_num; i ++) {
         if (target < (code->offset + code->len)) {
             break;
@@ -1669,6 +2328,44 @@ uint32_t sgl_search_unicode_ch_index(const sgl_font_t *font, uint32_t unicode)
 }
 
 
+/**
+ * @brief Decode a UTF-8 string into glyphs of font in one pass
+ * @param str Pointer to the string pointer, it will be moved to the first byte that is not decoded
+ * @param font Pointer to the font structure containing character data
+ * @param glyph Pointer to the glyph array to store the decoded glyphs
+ * @param num Capacity of the glyph array
+ * @return Number of decoded glyphs, 0 means the string is end
+ * @note '\n' is decoded as SGL_GLYPH_LINE_BREAK with zero advance width, the glyph array can be
+ *       reused to decode a long string chunk by chunk
+ */
+uint32_t sgl_font_decode_string(const char **str, const sgl_font_t *font, sgl_glyph_code_t *glyph, uint32_t num)
+{
+    SGL_ASSERT(str != NULL && font != NULL && glyph != NULL);
+    const char *s = *str;
+    uint32_t unicode = 0, ch_index = 0, count = 0;
+
+    while (count < num && *s) {
+        if (*s == '\n') {
+            glyph[count].index = SGL_GLYPH_LINE_BREAK;
+            glyph[count].adv_w = 0;
+            count ++;
+            s ++;
+            continue;
+        }
+
+        s += sgl_utf8_to_unicode(s, &unicode);
+        ch_index = sgl_search_unicode_ch_index(font, unicode);
+
+        glyph[count].index = (uint16_t)ch_index;
+        glyph[count].adv_w = (font->table[ch_index].adv_w >> 4);
+        count ++;
+    }
+
+    *str = s;
+    return count;
+}
+
+
 /**
  * @brief get the width of a string
  * @param str string
@@ -1678,14 +2375,16 @@ uint32_t sgl_search_unicode_ch_index(const sgl_font_t *font, uint32_t unicode)
 int32_t sgl_font_get_string_width(const char *str, const sgl_font_t *font)
 {
     SGL_ASSERT(font != NULL);
+    sgl_glyph_code_t glyph[SGL_GLYPH_CHUNK_SIZE];
+    uint32_t num = 0;
     int32_t len = 0;
-    uint32_t unicode = 0;
-    uint32_t ch_index = 0;
-    while (*str) {
-        str += sgl_utf8_to_unicode(str, &unicode);
-        ch_index = sgl_search_unicode_ch_index(font, unicode);
-        len += (font->table[ch_index].adv_w >> 4);
+
+    while ((num = sgl_font_decode_string(&str, font, glyph, SGL_GLYPH_CHUNK_SIZE)) > 0) {
+        for (uint32_t i = 0; i < num; i++) {
+            len += glyph[i].adv_w;
+        }
     }
+
     return len;
 }
 
@@ -1700,34 +2399,141 @@ int32_t sgl_font_get_string_width(const char *str, const sgl_font_t *font)
  */
 int32_t sgl_font_get_string_height(int16_t width, const char *str, const sgl_font_t *font, uint8_t line_space)
 {
+    sgl_glyph_code_t glyph[SGL_GLYPH_CHUNK_SIZE];
+    uint32_t num = 0;
     int16_t offset_x = 0;
-    int16_t ch_index;
-    int16_t ch_width;
     int16_t lines = 1;
-    uint32_t unicode = 0;
 
-    while (*str) {
-        if (*str == '\n') {
-            lines ++;
-            offset_x = 0;
-            str ++;
-            continue;
+    while ((num = sgl_font_decode_string(&str, font, glyph, SGL_GLYPH_CHUNK_SIZE)) > 0) {
+        for (uint32_t i = 0; i < num; i++) {
+            if (glyph[i].index == SGL_GLYPH_LINE_BREAK) {
+                lines ++;
+                offset_x = 0;
+                continue;
+            }
+
+            if ((offset_x + glyph[i].adv_w) >= width) {
+                offset_x = 0;
+                lines ++;
+            }
+
+            offset_x += glyph[i].adv_w;
         }
+    }
 
-        str += sgl_utf8_to_unicode(str, &unicode);
-        ch_index = sgl_search_unicode_ch_index(font, unicode);
+    return lines * (font->font_height + line_space);
+}
 
-        ch_width = (font->table[ch_index].adv_w >> 4);
 
-        if ((offset_x + ch_width) >= width) {
-            offset_x = 0;
-            lines ++;
+/**
+ * @brief release the glyph run of text layout
+ * @param layout point to text layout
+ * @return none
+ * @note the glyph buffer of user is kept for next build
+ */
+void sgl_text_layout_free(sgl_text_layout_t *layout)
+{
+    SGL_ASSERT(layout != NULL);
+
+    if (layout->capacity == 0) {
+        if (layout->glyph != NULL) {
+            sgl_free(layout->glyph);
         }
+        layout->glyph = NULL;
+    }
 
-        offset_x += ch_width;
+    layout->glyph_num = 0;
+    layout->width = 0;
+    layout->height = 0;
+}
+
+
+/**
+ * @brief measure a text and build its glyph run
+ * @param layout point to text layout, the old glyph run of layout will be released
+ * @param str string
+ * @param font sgl font of the string
+ * @param line_space peer line space
+ * @return int, 0 means successful, -1 means failed
+ * @note the glyph run is allocated from heap, you should call sgl_text_layout_free() to release it,
+ *       if the layout has a glyph buffer of user, the buffer is used and the heap is never used
+ */
+int sgl_text_layout_build(sgl_text_layout_t *layout, const char *str, const sgl_font_t *font, uint8_t line_space)
+{
+    SGL_ASSERT(layout != NULL && str != NULL && font != NULL);
+    sgl_glyph_code_t code[SGL_GLYPH_CHUNK_SIZE];
+    sgl_text_glyph_t *glyph = NULL;
+    uint32_t capacity = 0, num = 0;
+    uint16_t lines = 1;
+    int16_t offset_x = 0;
+
+    sgl_text_layout_free(layout);
+
+    /* every glyph starts with a byte that is neither continuation byte nor '\n',
+     * so the glyph run is allocated only once for valid UTF-8 string
+     */
+    for (const char *pos = str; *pos; pos ++) {
+        if ((*pos & 0xC0) != 0x80 && *pos != '\n') {
+            capacity ++;
+        }
     }
 
-    return lines * (font->font_height + line_space);
+    /* the glyph buffer of user is never grown, the text that does not fit is failed */
+    if (layout->capacity > 0) {
+        if (capacity > layout->capacity) {
+            SGL_LOG_ERROR("sgl_text_layout_build: glyph buffer is too small");
+            return -1;
+        }
+        capacity = layout->capacity;
+    }
+    else if (capacity > 0) {
+        layout->glyph = (sgl_text_glyph_t*)sgl_malloc(capacity * sizeof(sgl_text_glyph_t));
+        if (layout->glyph == NULL) {
+            SGL_LOG_ERROR("sgl_text_layout_build: malloc failed");
+            return -1;
+        }
+    }
+
+    while ((num = sgl_font_decode_string(&str, font, code, SGL_GLYPH_CHUNK_SIZE)) > 0) {
+        for (uint32_t i = 0; i < num; i++) {
+            if (code[i].index == SGL_GLYPH_LINE_BREAK) {
+                layout->width = sgl_max(layout->width, offset_x);
+                lines ++;
+                offset_x = 0;
+                continue;
+            }
+
+            /* grow the glyph run, only happens for invalid UTF-8 string */
+            if (unlikely(layout->glyph_num >= capacity)) {
+                if (layout->capacity > 0) {
+                    SGL_LOG_ERROR("sgl_text_layout_build: glyph buffer is too small");
+                    sgl_text_layout_free(layout);
+                    return -1;
+                }
+
+                capacity = layout->glyph_num + SGL_GLYPH_CHUNK_SIZE;
+                glyph = (sgl_text_glyph_t*)sgl_realloc(layout->glyph, capacity * sizeof(sgl_text_glyph_t));
+                if (glyph == NULL) {
+                    SGL_LOG_ERROR("sgl_text_layout_build: malloc failed");
+                    sgl_text_layout_free(layout);
+                    return -1;
+                }
+                layout->glyph = glyph;
+            }
+
+            glyph = &layout->glyph[layout->glyph_num ++];
+            glyph->index = code[i].index;
+            glyph->x = offset_x;
+            glyph->line = lines - 1;
+
+            offset_x += code[i].adv_w;
+        }
+    }
+
+    layout->width = sgl_max(layout->width, offset_x);
+    layout->height = lines * (font->font_height + line_space);
+
+    return 0;
 }
 
 
@@ -1961,6 +2767,8 @@ void sgl_obj_set_pos_align_ref(sgl_obj_t *ref, sgl_obj_t *obj, sgl_align_type_t
         SGL_LOG_WARN("invalid align type");
     break;
     }
+
+    sgl_obj_update_bbox(obj);
 }
 
 
@@ -1968,37 +2776,40 @@ void sgl_obj_set_pos_align_ref(sgl_obj_t *ref, sgl_obj_t *obj, sgl_align_type_t
  * @brief draw object slice completely
  * @param obj it should point to active root object
  * @param surf surface that draw to
- * @param dirty_h dirty height
+ * @param area dirty area
  * @return none
+ * @note every object is clipped by the coords of all its ancestors, so the subtree
+ *       out of its parent is not traversed, and the subtree is rejected by its bounding box
  */
 static inline void draw_obj_slice(sgl_obj_t *obj, sgl_surf_t *surf, sgl_area_t *area)
 {
-    int top = 0;
-	sgl_obj_t *stack[SGL_OBJ_DEPTH_MAX];
+    sgl_obj_t *root = obj;
+    sgl_area_t draw_area, cur = *area, child_clip;
 
 	SGL_ASSERT(obj != NULL);
-	stack[top++] = obj;
 
-	while (top > 0) {
-		SGL_ASSERT(top < SGL_OBJ_DEPTH_MAX);
-		obj = stack[--top];
+	while (obj != NULL) {
+        /* the whole subtree is hidden, or out of slice or clip */
+        if (sgl_obj_is_hidden(obj) || !sgl_surf_area_is_overlap(surf, &obj->bbox) || !sgl_area_is_overlap(&cur, &obj->bbox)) {
+            obj = obj_next_clip(obj, root, area, &cur);
+            continue;
+        }
 
-		if (obj->sibling != NULL) {
-			stack[top++] = obj->sibling;
+		draw_area = sgl_obj_get_draw_area(obj);
+		if (sgl_surf_area_is_overlap(surf, &draw_area) && sgl_area_is_overlap(&cur, &draw_area)) {
+			SGL_ASSERT(obj->construct_fn != NULL);
+			obj->construct_fn(surf, obj, &cur);
 		}
 
-        if (sgl_obj_is_hidden(obj)) {
+        /* children are clipped by object, skip the subtree if the clip is out of slice */
+        if (obj->child != NULL && sgl_area_clip(&cur, &obj->coords, &child_clip)
+            && sgl_surf_area_is_overlap(surf, &child_clip)) {
+            obj = obj->child;
+            cur = child_clip;
             continue;
         }
 
-		if (sgl_surf_area_is_overlap(surf, &obj->coords)) {
-			SGL_ASSERT(obj->construct_fn != NULL);
-			obj->construct_fn(surf, obj, area);
-
-            if (obj->child != NULL) {
-                stack[top++] = obj->child;
-            }
-		}
+        obj = obj_next_clip(obj, root, area, &cur);
 	}
 
     /* flush dirty area into screen */
@@ -2010,34 +2821,39 @@ static inline void draw_obj_slice(sgl_obj_t *obj, sgl_surf_t *surf, sgl_area_t *
  * @brief calculate dirty area by for each all object that is dirty and visible
  * @param obj it should point to active root object
  * @return bool true if dirty area is changed
- * @note if there is no dirty area, the dirty area will remain unchanged
+ * @note if there is no dirty area, the dirty area will remain unchanged. the area of object is
+ *       clipped by its ancestors before it is pushed, so the subtree whose bounding box is out
+ *       of its clip pushes nothing, but it is still walked to release destroyed objects.
  */
 static inline bool sgl_dirty_area_calculate(sgl_obj_t *obj)
 {
     bool changed = false;
-	sgl_obj_t *stack[SGL_OBJ_DEPTH_MAX];
-    int top = 0;
-    stack[top++] = obj;
+    sgl_obj_t *root = obj, *next;
+    sgl_area_t base = obj->coords, cur = obj->coords;
+    sgl_area_t draw_area;
+    bool visible;
 
     /* for each all object from the first task of page */
-	while (top > 0) {
-        SGL_ASSERT(top < SGL_OBJ_DEPTH_MAX);
-		obj = stack[--top];
-
-        /* if sibling exists, push it to stack, it will be pop in next loop */
-		if (obj->sibling != NULL) {
-			stack[top++] = obj->sibling;
-		}
-
+	while (obj != NULL) {
         /* if object is hidden, skip it */
         if (unlikely(sgl_obj_is_hidden(obj))) {
+            obj = obj_next_clip(obj, root, &base, &cur);
             continue;
         }
 
+        /* one test for the whole subtree */
+        visible = sgl_area_is_overlap(&cur, &obj->bbox);
+        draw_area = sgl_obj_get_draw_area(obj);
+
         /* check if obj is destroyed */
         if (unlikely(sgl_obj_is_destroyed(obj))) {
             /* merge destroy area */
-            sgl_dirty_area_push(&obj->coords);
+            if (visible && sgl_area_selfclip(&draw_area, &cur)) {
+                sgl_dirty_area_push(&draw_area);
+            }
+
+            /* the next object is got before the object is unlinked */
+            next = obj_next_clip(obj, root, &base, &cur);
 
             /* remove obj from parent */
             sgl_obj_remove(obj);
@@ -2047,13 +2863,16 @@ static inline bool sgl_dirty_area_calculate(sgl_obj_t *obj)
 
             changed = true;
             /* object is destroyed, skip */
+            obj = next;
             continue;
         }
 
         /* check child dirty and merge all dirty area */
         if (sgl_obj_is_dirty(obj)) {
             /* merge dirty area */
-            sgl_dirty_area_push(&obj->coords);
+            if (visible && sgl_area_selfclip(&draw_area, &cur)) {
+                sgl_dirty_area_push(&draw_area);
+            }
 
             changed = true;
             /* clear dirty flag */
@@ -2061,8 +2880,15 @@ static inline bool sgl_dirty_area_calculate(sgl_obj_t *obj)
         }
 
 		if (obj->child != NULL) {
-			stack[top++] = obj->child;
+            /* the clip of invisible subtree is empty */
+            if (!visible || !sgl_area_selfclip(&cur, &obj->coords)) {
+                sgl_area_init(&cur);
+            }
+			obj = obj->child;
+            continue;
 		}
+
+        obj = obj_next_clip(obj, root, &base, &cur);
     }
 
     return changed;
@@ -2113,6 +2939,14 @@ static inline void sgl_draw_task(sgl_fbdev_t *fbdev)
         /* draw object slice until the dirty area is finished */
         draw_obj_slice(head, surf, dirty);
         surf->y1 += draw_h;
+
+#if (CONFIG_SGL_EXTERNAL_PIXMAP)
+        /* the band is flushing, prefetch the external pixmap rows of next band */
+        if (surf->y1 <= dirty->y2) {
+            pixmap_cache_prefetch(sgl_min(dirty->y2 - surf->y1 + 1, surf->h));
+        }
+        sgl_system.pixmap_cache.hint_num = 0;
+#endif
     }
 
     /* clear dirty area */
@@ -2138,4 +2972,8 @@ void sgl_task_handle_sync(void)
         /* draw all object into screen */
         sgl_draw_task(&sgl_system.fbdev);
     }
+
+    /* the transient memory of frame is released */
+    sgl_frame_arena_reset();
+    sgl_mm_frame_mark();
 }
@@ -40,6 +40,22 @@ extern "C" {
 #define CONFIG_SGL_HEAP_SIZE                     (10240)
 #endif
 
+/* log2 of the largest memory pool, every pool that is added should not be larger than
+ * 2^CONFIG_SGL_FL_INDEX_MAX bytes, such as 1 MiB by default, the pool that is larger is rejected.
+ * it should be raised for the large external pool, each level adds 2^CONFIG_SGL_SL_INDEX_COUNT_LOG2
+ * pointers into the control structure that is taken from the first pool of heap
+ */
+#ifndef CONFIG_SGL_FL_INDEX_MAX
+#define CONFIG_SGL_FL_INDEX_MAX                  (20)
+#endif
+
+/* log2 of the number of subdivisions of every size level, 4 keeps the control structure
+ * small for small heap, 5 reduces the waste of large blocks
+ */
+#ifndef CONFIG_SGL_SL_INDEX_COUNT_LOG2
+#define CONFIG_SGL_SL_INDEX_COUNT_LOG2           (4)
+#endif
+
 #ifndef CONFIG_SGL_DEBUG
 #define CONFIG_SGL_DEBUG                         (0)
 #endif
@@ -52,12 +68,72 @@ extern "C" {
 #define CONFIG_SGL_FONT_SMALL_TABLE              (0)
 #endif
 
-/* the maximum depth of object*/
-#define  SGL_OBJ_DEPTH_MAX                       (8)
+#ifndef CONFIG_SGL_FONT_INDEX
+#define CONFIG_SGL_FONT_INDEX                    (0)
+#endif
+
+#ifndef CONFIG_SGL_EXTERNAL_PIXMAP
+#define CONFIG_SGL_EXTERNAL_PIXMAP               (0)
+#endif
+
+#ifndef CONFIG_SGL_PIXMAP_CACHE_BLOCK_SIZE
+#define CONFIG_SGL_PIXMAP_CACHE_BLOCK_SIZE       (256)
+#endif
+
+#ifndef CONFIG_SGL_PIXMAP_CACHE_BLOCK_NUM
+#define CONFIG_SGL_PIXMAP_CACHE_BLOCK_NUM        (8)
+#endif
+
+#ifndef CONFIG_SGL_MM_TRACE
+#define CONFIG_SGL_MM_TRACE                      (CONFIG_SGL_DEBUG)
+#endif
+
+#ifndef CONFIG_SGL_MM_TRACE_SITE_NUM
+#define CONFIG_SGL_MM_TRACE_SITE_NUM             (32)
+#endif
+
+#ifndef CONFIG_SGL_FRAME_ARENA_SIZE
+#define CONFIG_SGL_FRAME_ARENA_SIZE              (1024)
+#endif
+
+/* size of the chunks that objects of page are bumped from, 0 means objects are from slab.
+ * the object that is deleted alone is reused by the objects of same slab class in its page,
+ * so its size should take a slab class, otherwise its storage is kept until page is deleted
+ */
+#ifndef CONFIG_SGL_PAGE_ARENA_SIZE
+#define CONFIG_SGL_PAGE_ARENA_SIZE               (0)
+#endif
+
+#ifndef CONFIG_SGL_MM_HEAP_NUM
+#define CONFIG_SGL_MM_HEAP_NUM                   (2)
+#endif
+
+#ifndef CONFIG_SGL_MM_POOL_NUM
+#define CONFIG_SGL_MM_POOL_NUM                   (4)
+#endif
+
+#ifndef CONFIG_SGL_MM_THREAD_NUM
+#define CONFIG_SGL_MM_THREAD_NUM                 (0)
+#endif
+
+#ifndef CONFIG_SGL_MM_CACHE_DEPTH
+#define CONFIG_SGL_MM_CACHE_DEPTH                (8)
+#endif
+
+#ifndef CONFIG_SGL_SLAB_CLASS_NUM
+#define CONFIG_SGL_SLAB_CLASS_NUM                (4)
+#endif
+
+#ifndef CONFIG_SGL_SLAB_CHUNK_NUM
+#define CONFIG_SGL_SLAB_CHUNK_NUM                (8)
+#endif
+
 /* the maximum number of drawing buffers */
 #define  SGL_DRAW_BUFFER_MAX                     (2)
 /* define default animation tick ms */
 #define  SGL_SYSTEM_TICK_MS                      CONFIG_SGL_SYSTICK_MS
+/* the maximum number of external pixmaps that are prefetched in one band */
+#define  SGL_PIXMAP_PREFETCH_MAX                 (4)
 
 
 /**
@@ -128,7 +204,14 @@ extern "C" {
 #define SGL_COLOR_RGB888                        (24)
 #define SGL_COLOR_ARGB8888                      (32)
 
-/* the pixmap format */
+/* the pixmap format
+ * RLE formats: the bitmap starts with a row index, uint32_t little endian byte offset of every
+ * row from the start of bitmap, and then the packets of rows, a row never shares a packet with
+ * the next row. A packet starts with a head byte, bit7 = 1 means that the next one pixel is
+ * repeated, bit7 = 0 means that literal pixels follow, and bit0~6 is the pixel count - 1.
+ * Pixel bytes of raw and RLE formats: RGB332 1 byte, RGB565 2 bytes little endian,
+ * RGB888 3 bytes B, G, R, RGBA8888 4 bytes B, G, R, A. SGL_PIXMAP_FMT_NONE is native color.
+ */
 #define  SGL_PIXMAP_FMT_NONE                    (0)
 #define  SGL_PIXMAP_FMT_RGB332                  (1)
 #define  SGL_PIXMAP_FMT_RGB565                  (2)
@@ -138,7 +221,8 @@ extern "C" {
 #define  SGL_PIXMAP_FMT_RLE_RGB888              (6)
 #define  SGL_PIXMAP_FMT_RLE_RGBA8888            (7)
 #define  SGL_PIXMAP_FMT_RLE_1                   (8)
-#define  SGL_PIXMAP_FMT_MAX                     (9)
+#define  SGL_PIXMAP_FMT_RGBA8888                (9)
+#define  SGL_PIXMAP_FMT_MAX                     (10)
 
 
 #ifdef __GNUC__            /* gcc compiler   */
@@ -271,9 +355,9 @@ typedef union {
                                                                .ch.green   = (g) >> 2,         \
                                                                .ch.red     = (r) >> 3,}
 #elif (CONFIG_SGL_FBDEV_PIXEL_DEPTH == SGL_COLOR_RGB233)
-#define sgl_rgb(r,g,b)                          (sgl_color_t){ .ch.blue    = (b >> 6),         \
-                                                               .ch.green   = (g >> 5),         \
-                                                               .ch.red     = (r >> 5),}
+#define sgl_rgb(r,g,b)                          (sgl_color_t){ .ch.blue    = (b) >> 6,         \
+                                                               .ch.green   = (g) >> 5,         \
+                                                               .ch.red     = (r) >> 5,}
 #endif
 
 
@@ -601,6 +685,8 @@ typedef struct sgl_surf {
 * @width: pixmap width
 * @height: pixmap height
 * @format: bitmap format 0: no compression, 1:
+* @external: the bitmap is in external memory, and it is read by the registered read callback,
+*            only raw formats are supported in external memory
 * @bitmap: point to image bitmap
 *          data: address for internal flash memory
 *          addr: address for external flash memory
@@ -608,7 +694,8 @@ typedef struct sgl_surf {
 typedef struct sgl_pixmap {
     uint32_t width : 13;
     uint32_t height : 13;
-    uint32_t format : 6;
+    uint32_t format : 5;
+    uint32_t external : 1;
     union {
         const uint8_t *data;
         const size_t  addr;
@@ -674,6 +761,63 @@ typedef struct sgl_font_unicode {
 } sgl_font_unicode_t;
 
 
+/**
+ * @brief This structure defines a page of font unicode index, a page covers 256 unicodes
+ * @bitmap: bit map of unicodes that the font contains in this page
+ * @base: index of the first character of this page in the font table
+ * @rank: number of characters before each word of bitmap
+ */
+typedef struct sgl_font_index_page {
+    uint32_t  bitmap[8];
+    uint16_t  base;
+    uint8_t   rank[8];
+} sgl_font_index_page_t;
+
+
+/**
+ * @brief This structure defines a two level unicode index of font, it is built at the first search,
+ *        and then unicode can be searched in O(1) time
+ * @root: slot of page for every unicode page of font, SGL_FONT_INDEX_EMPTY means no character
+ * @page: point to pages that contain characters
+ * @first: first unicode page of font
+ * @page_num: number of unicode pages from first to last
+ * @status: status of index, see SGL_FONT_INDEX_*
+ * @size: bytes of memory that index used
+ */
+typedef struct sgl_font_index {
+    uint16_t               *root;
+    sgl_font_index_page_t  *page;
+    uint16_t               first;
+    uint16_t               page_num;
+    uint8_t                status;
+    uint32_t               size;
+} sgl_font_index_t;
+
+#define  SGL_FONT_INDEX_EMPTY                   (0xFFFF)
+#define  SGL_FONT_INDEX_NONE                    (0)
+#define  SGL_FONT_INDEX_READY                   (1)
+#define  SGL_FONT_INDEX_UNAVAILABLE             (2)
+
+
+/**
+ * @brief Row seek entry of compressed glyph, it is the RLE decoder state at the start of a
+ *        glyph row, so that the rows above the clip area can be skipped without decoding
+ * @rdp: bit position of the row from the start of glyph bitmap
+ * @state: RLE state at the start of the row, 0: single, 1: repeated, 2: counter
+ * @count: RLE counter at the start of the row
+ * @prev_v: previous pixel value at the start of the row
+ * @note the font converter emits one entry for every rle_seek_step rows of a glyph, starting
+ *       from row rle_seek_step, the entries of all glyphs are stored in one array in glyph order,
+ *       and rle_seek_offset[ch_index] is the first entry of the glyph
+ */
+typedef struct sgl_font_rle_seek {
+    uint32_t rdp : 20;
+    uint32_t state : 2;
+    uint32_t count : 6;
+    uint32_t prev_v : 4;
+} sgl_font_rle_seek_t;
+
+
 /**
 * @brief A structure used to describe information about a font, Defining a font set requires
 *        the use of this structure to describe relevant information
@@ -687,6 +831,10 @@ typedef struct sgl_font_unicode {
 * @base_line: base line of font
 * @bpp: The anti aliasing level of the font, only support 2, 4
 * @compress: compress flag, 0: no compress, 1: compress
+* @index: point to unicode index of font, NULL means search unicode without index
+* @rle_seek: point to row seek entries of compressed glyphs, NULL means no seek entries
+* @rle_seek_offset: index of first row seek entry of every glyph
+* @rle_seek_step: rows between two row seek entries, 0 means the seek entries are not used
 */
 typedef struct sgl_font {
     const uint8_t  *bitmap;
@@ -698,23 +846,86 @@ typedef struct sgl_font {
     const int16_t   base_line;
     const uint8_t   bpp;
     const uint8_t   compress;
+#if (CONFIG_SGL_FONT_INDEX)
+    sgl_font_index_t *index;
+#endif
+#if (CONFIG_SGL_FONT_COMPRESSED)
+    const sgl_font_rle_seek_t *rle_seek;
+    const uint32_t  *rle_seek_offset;
+    const uint8_t   rle_seek_step;
+#endif
 } sgl_font_t;
 
 
+/**
+ * @brief This structure defines a glyph that is decoded from string
+ * @index: index of the character in the font table, SGL_GLYPH_LINE_BREAK means a line break
+ * @adv_w: advance width of the glyph
+ */
+typedef struct sgl_glyph_code {
+    uint16_t  index;
+    uint16_t  adv_w;
+} sgl_glyph_code_t;
+
+
+#define SGL_GLYPH_LINE_BREAK                    (0xFFFF)
+#define SGL_GLYPH_CHUNK_SIZE                    (32)
+#define SGL_UNICODE_REPLACEMENT                 (0xFFFD)
+
+
+/**
+ * @brief This structure defines a glyph of the text layout
+ * @index: index of the character in the font table
+ * @x: x offset of the glyph from the start of its line
+ * @line: line number of the glyph
+ */
+typedef struct sgl_text_glyph {
+    uint16_t  index;
+    int16_t   x;
+    uint16_t  line;
+} sgl_text_glyph_t;
+
+
+/**
+ * @brief This structure defines the measured layout of a text, it is used to cache the result
+ *        of text measurement, so that the text is not decoded and searched again on every draw
+ * @glyph: point to glyph run of the text
+ * @capacity: number of glyphs of the buffer that is given by user, 0 means the glyph run is
+ *            allocated from heap
+ * @glyph_num: number of glyphs in the glyph run
+ * @width: width of the widest line
+ * @height: height of all lines
+ */
+typedef struct sgl_text_layout {
+    sgl_text_glyph_t  *glyph;
+    uint16_t          capacity;
+    uint16_t          glyph_num;
+    int16_t           width;
+    int16_t           height;
+} sgl_text_layout_t;
+
+
 typedef struct sgl_obj {
     sgl_area_t      coords;
     void            (*construct_fn)(sgl_surf_t *surf, struct sgl_obj *obj, sgl_area_t *area);
+    void            (*destroy_fn)(struct sgl_obj *obj);
     struct sgl_obj  *parent;
     struct sgl_obj  *child;
+    struct sgl_obj  *tail;
     struct sgl_obj  *sibling;
+    struct sgl_obj  *prev;
     uint8_t         destroyed : 1;
     uint8_t         dirty : 1;
     uint8_t         hide : 1;
     uint8_t         needinit : 1;
     uint8_t         page : 1;
     uint8_t         layout : 2;
+    uint8_t         nofree : 1;
     uint8_t         border;
     uint8_t         radius;
+    uint8_t         ext_draw;
+    uint8_t         slab;
+    sgl_area_t      bbox;
 } sgl_obj_t;
 
 
@@ -731,12 +942,21 @@ typedef struct sgl_obj {
  * - color    : Default background color used when no pixmap is set.
  * - pixmap   : Optional pointer to a background pixmap. If non-NULL, it typically overrides 'color'
  *              as the background content during rendering (behavior depends on flush/render logic).
+ * - arena    : Chunks that objects of page are bumped from, they are linked by their first word.
+ * - arena_pos: Used size of the first chunk.
+ * - arena_end: Size of the first chunk.
+ * - arena_free: Objects that are deleted alone, they are linked by their first word per slab class.
  */
 typedef struct sgl_page {
     sgl_obj_t          obj;
-    sgl_obj_t          *tail;
     sgl_color_t        color;
     const sgl_pixmap_t *pixmap;
+#if (CONFIG_SGL_PAGE_ARENA_SIZE)
+    uint8_t            *arena;
+    size_t             arena_pos;
+    size_t             arena_end;
+    void               *arena_free[CONFIG_SGL_SLAB_CLASS_NUM];
+#endif
 } sgl_page_t;
 
 
@@ -777,6 +997,63 @@ typedef struct sgl_fbdev {
 } sgl_fbdev_t;
 
 
+#if (CONFIG_SGL_EXTERNAL_PIXMAP)
+/**
+ * @brief prefetch hint of external pixmap, it records the last row segment read in current band
+ * @pixmap: pointer to pixmap
+ * @addr: address of the last row segment
+ * @len: bytes of the row segment
+ */
+typedef struct sgl_pixmap_hint {
+    const sgl_pixmap_t *pixmap;
+    size_t             addr;
+    uint32_t           len;
+} sgl_pixmap_hint_t;
+
+
+/**
+ * @brief block cache of external pixmap
+ * @read: read callback of external memory, return 0 means successful
+ * @tag: block number + 1 of every cache block, 0 means the cache block is empty
+ * @stamp: last used time of every cache block, the least recently used block is replaced
+ * @clock: current time of cache
+ * @hint_num: number of prefetch hints
+ * @hint: prefetch hints of current band
+ * @block: data of cache blocks
+ */
+typedef struct sgl_pixmap_cache {
+    int                (*read)(size_t addr, uint8_t *buf, uint32_t len);
+    uint32_t           tag[CONFIG_SGL_PIXMAP_CACHE_BLOCK_NUM];
+    uint32_t           stamp[CONFIG_SGL_PIXMAP_CACHE_BLOCK_NUM];
+    uint32_t           clock;
+    uint8_t            hint_num;
+    sgl_pixmap_hint_t  hint[SGL_PIXMAP_PREFETCH_MAX];
+    uint8_t            block[CONFIG_SGL_PIXMAP_CACHE_BLOCK_NUM][CONFIG_SGL_PIXMAP_CACHE_BLOCK_SIZE];
+} sgl_pixmap_cache_t;
+#endif
+
+
+/**
+ * @brief blurred corner mask of shadow, the last row of mask is the 1-D profile of the
+ *        straight edges, and the mask is mirrored to the four corners. the mask is shared
+ *        by the shadows of same radius and blur, it's freed when no shadow uses it
+ * @next: next shared mask
+ * @ref: number of shadows that use the mask
+ * @radius: corner radius of shadow shape
+ * @blur: half width of box blur
+ * @size: side length of mask
+ * @mask: A8 mask of size * size
+ */
+typedef struct sgl_shadow_mask {
+    struct sgl_shadow_mask *next;
+    uint16_t           ref;
+    int16_t            radius;
+    uint8_t            blur;
+    uint16_t           size;
+    uint8_t            mask[];
+} sgl_shadow_mask_t;
+
+
 /**
  * @brief sgl log print device struct
  * @logdev: log print callback function pointer
@@ -789,7 +1066,12 @@ typedef struct sgl_system {
 #if (CONFIG_SGL_FBDEV_ROTATION != 0)
     sgl_color_t        *rotation;
 #endif
+#if (CONFIG_SGL_EXTERNAL_PIXMAP)
+    sgl_pixmap_cache_t pixmap_cache;
+#endif
+    sgl_shadow_mask_t  *shadow_mask;
     uint8_t            mem_pool[CONFIG_SGL_HEAP_SIZE];
+    uint8_t            frame_arena[CONFIG_SGL_FRAME_ARENA_SIZE];
 } sgl_system_t;
 
 
@@ -1125,6 +1407,42 @@ static inline void sgl_logdev_register(void (*puts)(const char *str))
 }
 
 
+#if (CONFIG_SGL_EXTERNAL_PIXMAP)
+/**
+ * @brief register read callback of external pixmap memory
+ * @param read read callback, read len bytes from addr into buf, return 0 means successful
+ * @return none
+ * @note the pixmap that external flag is set is read by this callback through block cache
+ */
+static inline void sgl_pixmap_read_register(int (*read)(size_t addr, uint8_t *buf, uint32_t len))
+{
+    sgl_system.pixmap_cache.read = read;
+    memset(sgl_system.pixmap_cache.tag, 0, sizeof(sgl_system.pixmap_cache.tag));
+}
+
+
+/**
+ * @brief read external pixmap memory through block cache
+ * @param addr address of external memory
+ * @param buf buffer to store data
+ * @param len bytes of data
+ * @return int, 0 means successful, -1 means failed
+ */
+int sgl_pixmap_cache_read(size_t addr, uint8_t *buf, uint32_t len);
+
+
+/**
+ * @brief record the row segment of external pixmap that is read in current band, the same
+ *        columns of the rows in next band will be prefetched after current band is flushed
+ * @param pixmap pointer to pixmap
+ * @param addr address of row segment
+ * @param len bytes of row segment
+ * @return none
+ */
+void sgl_pixmap_cache_hint(const sgl_pixmap_t *pixmap, size_t addr, uint32_t len);
+#endif
+
+
 /**
  * @brief log output function
  * @param str log string
@@ -1253,7 +1571,9 @@ static inline void sgl_obj_node_init(sgl_obj_t *obj)
     SGL_ASSERT(obj != NULL);
 
     obj->sibling = NULL;
+    obj->prev = NULL;
     obj->child = NULL;
+    obj->tail = NULL;
 }
 
 
@@ -1378,6 +1698,35 @@ static inline bool sgl_obj_is_destroyed(sgl_obj_t *obj)
 }
 
 
+/**
+ * @brief get the area that object draws, it is the coords extended by the draw extension,
+ *        such as the shadow of object
+ * @param obj point to object
+ * @return draw area of object
+ */
+static inline sgl_area_t sgl_obj_get_draw_area(sgl_obj_t *obj)
+{
+    sgl_area_t area = {
+        .x1 = obj->coords.x1 - obj->ext_draw,
+        .y1 = obj->coords.y1 - obj->ext_draw,
+        .x2 = obj->coords.x2 + obj->ext_draw,
+        .y2 = obj->coords.y2 + obj->ext_draw,
+    };
+
+    return area;
+}
+
+
+/**
+ * @brief update the bounding box of object subtree, and its parents if it is changed
+ * @param obj point to object
+ * @return none
+ * @note the bounding box is the union of draw area of object and all its descendants,
+ *       it should be called after the coords or draw extension of object is changed
+ */
+void sgl_obj_update_bbox(sgl_obj_t *obj);
+
+
 /**
  * @brief Set object to dirty
  * @param obj point to object
@@ -1459,8 +1808,9 @@ static inline void sgl_obj_clear_needinit(sgl_obj_t *obj)
 static inline void sgl_obj_set_hidden(sgl_obj_t *obj)
 {
     SGL_ASSERT(obj != NULL);
+    sgl_area_t area = sgl_obj_get_draw_area(obj);
     obj->hide = 1;
-    sgl_dirty_area_push(&obj->coords);
+    sgl_dirty_area_push(&area);
 }
 
 
@@ -1472,8 +1822,9 @@ static inline void sgl_obj_set_hidden(sgl_obj_t *obj)
 static inline void sgl_obj_set_visible(sgl_obj_t *obj)
 {
     SGL_ASSERT(obj != NULL);
+    sgl_area_t area = sgl_obj_get_draw_area(obj);
     obj->hide = 0;
-    sgl_dirty_area_push(&obj->coords);
+    sgl_dirty_area_push(&area);
 }
 
 
@@ -1734,6 +2085,7 @@ static inline void sgl_obj_set_size(sgl_obj_t *obj, int16_t width, int16_t heigh
     SGL_ASSERT(obj != NULL);
     obj->coords.x2 = obj->coords.x1 + width - 1;
     obj->coords.y2 = obj->coords.y1 + height - 1;
+    sgl_obj_update_bbox(obj);
     sgl_obj_set_dirty(obj);
 }
 
@@ -1763,6 +2115,7 @@ static inline void sgl_obj_set_width(sgl_obj_t *obj, int16_t width)
 {
     SGL_ASSERT(obj != NULL);
     obj->coords.x2 = obj->coords.x1 + width - 1;
+    sgl_obj_update_bbox(obj);
 }
 
 
@@ -1788,6 +2141,7 @@ static inline void sgl_obj_set_height(sgl_obj_t *obj, int16_t height)
 {
     SGL_ASSERT(obj != NULL);
     obj->coords.y2 = obj->coords.y1 + height - 1;
+    sgl_obj_update_bbox(obj);
 }
 
 
@@ -1933,11 +2287,24 @@ void sgl_page_set_pixmap(sgl_obj_t* obj, const sgl_pixmap_t *pixmap);
 sgl_obj_t* sgl_obj_create(sgl_obj_t *parent);
 
 
+/**
+ * @brief  alloc memory of object from the slab class of its size, or from the arena of
+ *         its page if CONFIG_SGL_PAGE_ARENA_SIZE is set
+ * @param  size: size of object struct, the struct should begin with sgl_obj_t
+ * @param  parent: parent of object, NULL means active page
+ * @retval pointer of object that is set to zero, NULL means out of memory
+ * @note   the object should be released by sgl_obj_free()
+ */
+void* sgl_obj_alloc(size_t size, sgl_obj_t *parent);
+
+
 /**
  * @brief  free an object
  * @param  obj: object to free
  * @retval none
- * @note this function will free all the children of the object
+ * @note this function will free all the children of the object, the object whose
+ *       nofree flag is set is released but its storage is not freed, the siblings of
+ *       the object are not freed
  */
 void sgl_obj_free(sgl_obj_t *obj);
 
@@ -2068,6 +2435,18 @@ static inline sgl_color_t sgl_pixmap_get_pixel(const sgl_pixmap_t *pixmap, int16
 }
 
 
+/**
+ * @brief check the pixmap is run length encoded
+ * @pixmap: pointe to pixmap
+ * @return true means run length encoded, false means not
+ */
+static inline bool sgl_pixmap_is_rle(const sgl_pixmap_t *pixmap)
+{
+    SGL_ASSERT(pixmap != NULL);
+    return pixmap->format >= SGL_PIXMAP_FMT_RLE_RGB332 && pixmap->format <= SGL_PIXMAP_FMT_RLE_RGBA8888;
+}
+
+
 /**
  * @brief get pixel of pixmap buf
  * @pixmap: pointe to pixmap
@@ -2207,10 +2586,25 @@ int sgl_obj_init(sgl_obj_t *obj, sgl_obj_t *parent);
  * @param utf8_str Pointer to the UTF-8 string to be converted
  * @param p_unicode_buffer Pointer to the buffer where the converted Unicode will be stored
  * @return The number of bytes in the UTF-8 string
+ * @note invalid or truncated sequence is converted to SGL_UNICODE_REPLACEMENT and consumes one byte,
+ *       the decoder never reads over the end of string
  */
 uint32_t sgl_utf8_to_unicode(const char *utf8_str, uint32_t *p_unicode_buffer);
 
 
+/**
+ * @brief Decode a UTF-8 string into glyphs of font in one pass
+ * @param str Pointer to the string pointer, it will be moved to the first byte that is not decoded
+ * @param font Pointer to the font structure containing character data
+ * @param glyph Pointer to the glyph array to store the decoded glyphs
+ * @param num Capacity of the glyph array
+ * @return Number of decoded glyphs, 0 means the string is end
+ * @note '\n' is decoded as SGL_GLYPH_LINE_BREAK with zero advance width, the glyph array can be
+ *       reused to decode a long string chunk by chunk
+ */
+uint32_t sgl_font_decode_string(const char **str, const sgl_font_t *font, sgl_glyph_code_t *glyph, uint32_t num);
+
+
 /**
  * @brief Search for the index of a Unicode character in the font table
  * @param font Pointer to the font structure containing character data
@@ -2220,6 +2614,20 @@ uint32_t sgl_utf8_to_unicode(const char *utf8_str, uint32_t *p_unicode_buffer);
 uint32_t sgl_search_unicode_ch_index(const sgl_font_t *font, uint32_t unicode);
 
 
+#if (CONFIG_SGL_FONT_INDEX)
+/**
+ * @brief Get bytes of memory that unicode index of font used
+ * @param font Pointer to the font structure
+ * @return bytes of memory, 0 means the index is not built
+ */
+static inline uint32_t sgl_font_index_size(const sgl_font_t *font)
+{
+    SGL_ASSERT(font != NULL);
+    return font->index != NULL ? font->index->size : 0;
+}
+#endif
+
+
 /**
  * @brief get height in font
  * @param font pointer to sgl_font_t
@@ -2253,6 +2661,28 @@ int32_t sgl_font_get_string_width(const char *str, const sgl_font_t *font);
 int32_t sgl_font_get_string_height(int16_t width, const char *str, const sgl_font_t *font, uint8_t line_space);
 
 
+/**
+ * @brief measure a text and build its glyph run
+ * @param layout point to text layout, the old glyph run of layout will be released
+ * @param str string
+ * @param font sgl font of the string
+ * @param line_space peer line space
+ * @return int, 0 means successful, -1 means failed
+ * @note the glyph run is allocated from heap, you should call sgl_text_layout_free() to release it,
+ *       if the layout has a glyph buffer of user, the buffer is used and the heap is never used
+ */
+int sgl_text_layout_build(sgl_text_layout_t *layout, const char *str, const sgl_font_t *font, uint8_t line_space);
+
+
+/**
+ * @brief release the glyph run of text layout
+ * @param layout point to text layout
+ * @return none
+ * @note the glyph buffer of user is kept for next build
+ */
+void sgl_text_layout_free(sgl_text_layout_t *layout);
+
+
 /**
  * @brief get the alignment position
  * @param parent_size parent size
@@ -15,6 +15,7 @@
  */
 
 #include "sgl_core.h"
+#include "sgl_mm.h"
 #include "sgl_draw.h"
 
 /**
@@ -97,6 +98,420 @@ void sgl_draw_fill_rect_with_border(sgl_surf_t *surf, sgl_area_t *area, sgl_area
 }
 
 
+/**
+ * @brief pixmap row reader, it walks the pixels of one row, a row of raw pixmap is
+ *        walked as one literal packet, and a row segment of external pixmap is read
+ *        into data chunk by chunk, every chunk is walked as one literal packet
+ */
+typedef struct {
+    const uint8_t *pos;
+    const uint8_t *value;
+    uint16_t left;
+    uint8_t format;
+    uint8_t bytes;
+    uint8_t repeat;
+#if (CONFIG_SGL_EXTERNAL_PIXMAP)
+    uint8_t external;
+    uint32_t remain;
+    size_t addr;
+    uint8_t data[CONFIG_SGL_PIXMAP_CACHE_BLOCK_SIZE];
+#endif
+} sgl_pixmap_row_t;
+
+
+/**
+ * @brief get the raw format of pixmap format
+ * @param format pixmap format
+ * @return raw format, SGL_PIXMAP_FMT_NONE means native color
+ */
+static inline uint8_t pixmap_raw_format(uint8_t format)
+{
+    if (format >= SGL_PIXMAP_FMT_RLE_RGB332 && format <= SGL_PIXMAP_FMT_RLE_RGB888) {
+        format -= (SGL_PIXMAP_FMT_RLE_RGB332 - SGL_PIXMAP_FMT_RGB332);
+    }
+    else if (format == SGL_PIXMAP_FMT_RLE_RGBA8888) {
+        format = SGL_PIXMAP_FMT_RGBA8888;
+    }
+
+    /* the pixels can be copied directly if they are same as native color */
+#if (CONFIG_SGL_FBDEV_PIXEL_DEPTH == SGL_COLOR_RGB565)
+    if (format == SGL_PIXMAP_FMT_RGB565) {
+        format = SGL_PIXMAP_FMT_NONE;
+    }
+#elif (CONFIG_SGL_FBDEV_PIXEL_DEPTH == SGL_COLOR_RGB888)
+    if (format == SGL_PIXMAP_FMT_RGB888) {
+        format = SGL_PIXMAP_FMT_NONE;
+    }
+#elif (CONFIG_SGL_FBDEV_PIXEL_DEPTH == SGL_COLOR_RGB233)
+    if (format == SGL_PIXMAP_FMT_RGB332) {
+        format = SGL_PIXMAP_FMT_NONE;
+    }
+#endif
+    return format;
+}
+
+
+/**
+ * @brief convert a RGB332 pixel to color
+ * @param p pointer to pixel bytes
+ * @return color of pixel
+ */
+static inline sgl_color_t pixmap_rgb332_to_color(const uint8_t *p)
+{
+    /* the channels are expanded to 8 bits by repeating their bits */
+    uint8_t r = ((p[0] >> 5) * 0x49) >> 1;
+    uint8_t g = (((p[0] >> 2) & 0x7) * 0x49) >> 1;
+    uint8_t b = (p[0] & 0x3) * 0x55;
+
+    return sgl_rgb(r, g, b);
+}
+
+
+/**
+ * @brief convert a RGB565 pixel to color
+ * @param p pointer to pixel bytes
+ * @return color of pixel
+ */
+static inline sgl_color_t pixmap_rgb565_to_color(const uint8_t *p)
+{
+    uint16_t v = p[0] | (p[1] << 8);
+    uint8_t r = ((v >> 8) & 0xF8) | (v >> 13);
+    uint8_t g = ((v >> 3) & 0xFC) | ((v >> 9) & 0x3);
+    uint8_t b = ((v << 3) & 0xF8) | ((v >> 2) & 0x7);
+
+    return sgl_rgb(r, g, b);
+}
+
+
+/**
+ * @brief convert a RGB888 or RGBA8888 pixel to color
+ * @param p pointer to pixel bytes
+ * @return color of pixel
+ */
+static inline sgl_color_t pixmap_rgb888_to_color(const uint8_t *p)
+{
+    return sgl_rgb(p[2], p[1], p[0]);
+}
+
+
+/**
+ * @brief convert a pixel of pixmap to color
+ * @param format raw format of pixmap
+ * @param p pointer to pixel bytes
+ * @param alpha [out] alpha of pixel
+ * @return color of pixel
+ */
+static inline sgl_color_t pixmap_pixel_to_color(uint8_t format, const uint8_t *p, uint8_t *alpha)
+{
+    sgl_color_t color;
+    *alpha = SGL_ALPHA_MAX;
+
+    switch (format) {
+    case SGL_PIXMAP_FMT_RGB332:
+        return pixmap_rgb332_to_color(p);
+    case SGL_PIXMAP_FMT_RGB565:
+        return pixmap_rgb565_to_color(p);
+    case SGL_PIXMAP_FMT_RGB888:
+        return pixmap_rgb888_to_color(p);
+    case SGL_PIXMAP_FMT_RGBA8888:
+        *alpha = p[3];
+        return pixmap_rgb888_to_color(p);
+    default:
+        /* the pixels in RLE packet may be not aligned */
+        memcpy(&color, p, sizeof(sgl_color_t));
+        return color;
+    }
+}
+
+
+/**
+ * @brief blit literal pixels to surface, the format is checked once for all pixels
+ * @param buf pointer to surface buffer
+ * @param p pointer to pixel bytes
+ * @param format raw format of pixmap
+ * @param n number of pixels
+ * @param alpha alpha of pixmap
+ * @return none
+ */
+static void pixmap_blit_literal(sgl_color_t *buf, const uint8_t *p, uint8_t format, uint32_t n, uint8_t alpha)
+{
+    sgl_color_t color;
+    uint8_t color_alpha;
+
+    switch (format) {
+    case SGL_PIXMAP_FMT_NONE:
+        if (alpha == SGL_ALPHA_MAX) {
+            memcpy(buf, p, n * sizeof(sgl_color_t));
+            return;
+        }
+        for (; n > 0; n--, buf++, p += sizeof(sgl_color_t)) {
+            memcpy(&color, p, sizeof(sgl_color_t));
+            *buf = sgl_color_mixer(color, *buf, alpha);
+        }
+        break;
+
+    case SGL_PIXMAP_FMT_RGB332:
+        for (; n > 0; n--, buf++, p += 1) {
+            color = pixmap_rgb332_to_color(p);
+            *buf = (alpha == SGL_ALPHA_MAX ? color : sgl_color_mixer(color, *buf, alpha));
+        }
+        break;
+
+    case SGL_PIXMAP_FMT_RGB565:
+        for (; n > 0; n--, buf++, p += 2) {
+            color = pixmap_rgb565_to_color(p);
+            *buf = (alpha == SGL_ALPHA_MAX ? color : sgl_color_mixer(color, *buf, alpha));
+        }
+        break;
+
+    case SGL_PIXMAP_FMT_RGB888:
+        for (; n > 0; n--, buf++, p += 3) {
+            color = pixmap_rgb888_to_color(p);
+            *buf = (alpha == SGL_ALPHA_MAX ? color : sgl_color_mixer(color, *buf, alpha));
+        }
+        break;
+
+    case SGL_PIXMAP_FMT_RGBA8888:
+        /* transparent pixels are skipped, and opaque pixels are not blended */
+        for (; n > 0; n--, buf++, p += 4) {
+            color_alpha = p[3];
+            if (color_alpha == 0) {
+                continue;
+            }
+            color = pixmap_rgb888_to_color(p);
+            color = (color_alpha == SGL_ALPHA_MAX ? color : sgl_color_mixer(color, *buf, color_alpha));
+            *buf = (alpha == SGL_ALPHA_MAX ? color : sgl_color_mixer(color, *buf, alpha));
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+
+#if (CONFIG_SGL_EXTERNAL_PIXMAP)
+/**
+ * @brief read the next chunk of external pixmap row segment through the block cache
+ * @param row pixmap row reader
+ * @return int, 0 means successful, -1 means failed or the row segment is finished
+ * @note the rest of row segment is dropped if the read is failed, so that a failed
+ *       block is not read again by every pixel
+ */
+static int pixmap_row_next_chunk(sgl_pixmap_row_t *row)
+{
+    uint32_t k = sgl_min(row->remain, (uint32_t)(sizeof(row->data) / row->bytes));
+
+    if (k == 0 || sgl_pixmap_cache_read(row->addr, row->data, k * row->bytes) != 0) {
+        row->remain = 0;
+        return -1;
+    }
+
+    row->pos = row->data;
+    row->left = k;
+    row->addr += k * row->bytes;
+    row->remain -= k;
+    return 0;
+}
+#endif
+
+
+/**
+ * @brief start the next packet of pixmap row, the next chunk is read for external pixmap
+ * @param row pixmap row reader
+ * @return int, 0 means successful, -1 means failed
+ */
+static inline int pixmap_row_next_packet(sgl_pixmap_row_t *row)
+{
+    uint8_t head;
+
+#if (CONFIG_SGL_EXTERNAL_PIXMAP)
+    if (row->external) {
+        return pixmap_row_next_chunk(row);
+    }
+#endif
+
+    head = *row->pos++;
+
+    row->repeat = head & 0x80;
+    row->left = (head & 0x7F) + 1;
+
+    if (row->repeat) {
+        row->value = row->pos;
+        row->pos += row->bytes;
+    }
+
+    return 0;
+}
+
+
+/**
+ * @brief skip pixels of pixmap row, the whole packets are skipped without decoding
+ * @param row pixmap row reader
+ * @param n number of pixels
+ * @return none
+ */
+static inline void pixmap_row_skip(sgl_pixmap_row_t *row, uint32_t n)
+{
+    uint32_t k;
+
+    while (n > 0) {
+        if (row->left == 0) {
+            pixmap_row_next_packet(row);
+        }
+
+        k = sgl_min(n, (uint32_t)row->left);
+        if (!row->repeat) {
+            row->pos += k * row->bytes;
+        }
+        row->left -= k;
+        n -= k;
+    }
+}
+
+
+/**
+ * @brief seek pixmap row reader to a pixel, the row of RLE pixmap is found by the row index
+ * @param row pixmap row reader
+ * @param pixmap pointer to pixmap
+ * @param x x position of pixel in pixmap
+ * @param y y position of pixel in pixmap
+ * @param n number of pixels that will be read from the row
+ * @return none
+ */
+static inline void pixmap_row_seek(sgl_pixmap_row_t *row, const sgl_pixmap_t *pixmap, int16_t x, int16_t y, uint32_t n)
+{
+    const uint8_t *index = NULL;
+
+    row->format = pixmap_raw_format(pixmap->format);
+    row->bytes = sgl_pixmal_get_bits(pixmap);
+    row->repeat = 0;
+
+#if (CONFIG_SGL_EXTERNAL_PIXMAP)
+    /* the external pixmap must be raw, and only the row segment is read through the block cache */
+    row->external = pixmap->external;
+    if (row->external) {
+        SGL_ASSERT(!sgl_pixmap_is_rle(pixmap));
+        row->addr = pixmap->bitmap.addr + (y * pixmap->width + x) * row->bytes;
+        row->remain = n;
+        row->left = 0;
+        sgl_pixmap_cache_hint(pixmap, row->addr, n * row->bytes);
+        return;
+    }
+#else
+    SGL_UNUSED(n);
+#endif
+
+    if (!sgl_pixmap_is_rle(pixmap)) {
+        row->pos = pixmap->bitmap.data + (y * pixmap->width + x) * row->bytes;
+        row->left = pixmap->width - x;
+        return;
+    }
+
+    index = &pixmap->bitmap.data[y * 4];
+    row->pos = pixmap->bitmap.data + (index[0] | (index[1] << 8) | (index[2] << 16) | ((uint32_t)index[3] << 24));
+    row->left = 0;
+    pixmap_row_skip(row, x);
+}
+
+
+/**
+ * @brief get next pixel of pixmap row, the pixel is blended with background by its alpha
+ * @param row pixmap row reader
+ * @param bg background color
+ * @return color of pixel
+ */
+static inline sgl_color_t pixmap_row_next(sgl_pixmap_row_t *row, sgl_color_t bg)
+{
+    const uint8_t *p;
+    sgl_color_t color;
+    uint8_t alpha;
+
+    /* the pixel that can not be read keeps the background */
+    if (row->left == 0 && pixmap_row_next_packet(row) != 0) {
+        return bg;
+    }
+
+    if (row->repeat) {
+        p = row->value;
+    }
+    else {
+        p = row->pos;
+        row->pos += row->bytes;
+    }
+    row->left --;
+
+    color = pixmap_pixel_to_color(row->format, p, &alpha);
+    return alpha == SGL_ALPHA_MAX ? color : sgl_color_mixer(color, bg, alpha);
+}
+
+
+/**
+ * @brief blit pixels of pixmap row to surface, the literal pixels are blitted by format,
+ *        and the repeated pixels are converted only once
+ * @param row pixmap row reader
+ * @param buf pointer to surface buffer
+ * @param n number of pixels
+ * @param alpha alpha of pixmap
+ * @return none
+ */
+static void pixmap_row_blit(sgl_pixmap_row_t *row, sgl_color_t *buf, uint32_t n, uint8_t alpha)
+{
+    sgl_color_t color;
+    uint8_t color_alpha;
+    uint32_t k;
+
+    while (n > 0) {
+        if (row->left == 0 && pixmap_row_next_packet(row) != 0) {
+            return;
+        }
+
+        k = sgl_min(n, (uint32_t)row->left);
+        row->left -= k;
+        n -= k;
+
+        if (!row->repeat) {
+            pixmap_blit_literal(buf, row->pos, row->format, k, alpha);
+            row->pos += k * row->bytes;
+            buf += k;
+            continue;
+        }
+
+        color = pixmap_pixel_to_color(row->format, row->value, &color_alpha);
+        if (color_alpha == SGL_ALPHA_MAX && alpha == SGL_ALPHA_MAX) {
+            for (; k > 0; k--) {
+                *buf++ = color;
+            }
+        }
+        else {
+            for (; k > 0; k--, buf++) {
+                sgl_color_t pix = (color_alpha == SGL_ALPHA_MAX ? color : sgl_color_mixer(color, *buf, color_alpha));
+                *buf = (alpha == SGL_ALPHA_MAX ? pix : sgl_color_mixer(pix, *buf, alpha));
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief get the area of pixmap that is placed at the center of rect
+ * @param rect rect that the pixmap is placed in
+ * @param pixmap pointer to pixmap
+ * @return area of pixmap
+ */
+static inline sgl_area_t pixmap_get_area(sgl_area_t *rect, const sgl_pixmap_t *pixmap)
+{
+    sgl_area_t pick = {
+        .x1 = rect->x1 + ((rect->x2 - rect->x1 + 1) - (int)pixmap->width) / 2,
+        .y1 = rect->y1 + ((rect->y2 - rect->y1 + 1) - (int)pixmap->height) / 2,
+    };
+
+    pick.x2 = pick.x1 + pixmap->width - 1;
+    pick.y2 = pick.y1 + pixmap->height - 1;
+    return pick;
+}
+
+
 /**
  * @brief fill rect on surface with pixmap and alpha
  * @param surf  surface pointer
@@ -105,12 +520,14 @@ void sgl_draw_fill_rect_with_border(sgl_surf_t *surf, sgl_area_t *area, sgl_area
  * @param pixmap pixmap pointer
  * @param alpha alpha
  * @return none
+ * @note the pixels are converted from the format of pixmap, and the RLE pixmap is decoded
+ *       only in the rows of area, by the row index of pixmap
  */
 void sgl_draw_fill_rect_pixmap(sgl_surf_t *surf, sgl_area_t *area, sgl_rect_t *rect, const sgl_pixmap_t *pixmap, uint8_t alpha)
 {
     sgl_area_t clip;
     sgl_color_t *buf = NULL;
-    sgl_color_t *pbuf = NULL;
+    sgl_pixmap_row_t row;
 
     if (!sgl_surf_clip(surf, rect, &clip)) {
         return;
@@ -120,19 +537,16 @@ void sgl_draw_fill_rect_pixmap(sgl_surf_t *surf, sgl_area_t *area, sgl_rect_t *r
         return;
     }
 
-    int cx = (rect->x1 + rect->x2) / 2;
-    int cy = (rect->y1 + rect->y2) / 2;
-    int pick_cx = pixmap->width / 2;
-    int pick_cy = pixmap->height / 2;
+    /* the pixmap is placed at the center of rect, and never read out of its bound */
+    sgl_area_t pick = pixmap_get_area(rect, pixmap);
+    if (!sgl_area_selfclip(&clip, &pick)) {
+        return;
+    }
 
     for (int y = clip.y1; y <= clip.y2; y++) {
         buf = sgl_surf_get_buf(surf, clip.x1 - surf->x1, y - surf->y1);
-        pbuf = sgl_pixmap_get_buf(pixmap, pick_cx - (cx - clip.x1 + 1), pick_cy - (cy - y + 1));
-
-        for (int x = clip.x1; x <= clip.x2; x++, buf++) {
-            *buf = (alpha == SGL_ALPHA_MAX ? *pbuf : sgl_color_mixer(*pbuf, *buf, alpha));
-            pbuf ++;
-        }
+        pixmap_row_seek(&row, pixmap, clip.x1 - pick.x1, y - pick.y1, clip.x2 - clip.x1 + 1);
+        pixmap_row_blit(&row, buf, clip.x2 - clip.x1 + 1, alpha);
     }
 }
 
@@ -329,10 +743,7 @@ void sgl_draw_fill_round_rect_pixmap(sgl_surf_t *surf, sgl_area_t *area, sgl_are
     int cy2 = rect->y2 - radius;
     int cx_tmp = 0;
     int cy_tmp = 0;
-    int cx = (rect->x1 + rect->x2) / 2;
-    int cy = (rect->y1 + rect->y2) / 2;
-    int pick_cx = pixmap->width / 2;
-    int pick_cy = pixmap->height / 2;
+    sgl_area_t pick = pixmap_get_area(rect, pixmap);
 
     if (!sgl_surf_clip(surf, area, &clip)) {
         return;
@@ -342,24 +753,32 @@ void sgl_draw_fill_round_rect_pixmap(sgl_surf_t *surf, sgl_area_t *area, sgl_are
         return;
     }
 
+    if (!sgl_area_selfclip(&clip, &pick)) {
+        return;
+    }
+
     int y2 = 0, real_r2 = 0;
     int r2 = sgl_pow2(radius);
     int r2_edge = sgl_pow2(radius + 1);
+    sgl_pixmap_row_t row;
+    sgl_color_t pix;
 
     for (int y = clip.y1; y <= clip.y2; y++) {
         buf = sgl_surf_get_buf(surf, clip.x1 - surf->x1, y - surf->y1);
-        pbuf = sgl_pixmap_get_buf(pixmap, pick_cx - (cx - clip.x1 + 1), pick_cy - (cy - y + 1));
+        pixmap_row_seek(&row, pixmap, clip.x1 - pick.x1, y - pick.y1, clip.x2 - clip.x1 + 1);
 
         if (y > cy1 && y < cy2) {
-            for (int x = clip.x1; x <= clip.x2; x++, buf++, pbuf++) {
-                *buf = (alpha == SGL_ALPHA_MAX ? *pbuf : sgl_color_mixer(*pbuf, *buf, alpha));
-            }
+            pixmap_row_blit(&row, buf, clip.x2 - clip.x1 + 1, alpha);
         }
         else {
             cy_tmp = y > cy1 ? cy2 : cy1;
             y2 = sgl_pow2(y - cy_tmp);
 
-            for (int x = clip.x1; x <= clip.x2; x++, buf++, pbuf++) {
+            /* the pixel is converted into pix, and pbuf points to it */
+            for (int x = clip.x1; x <= clip.x2; x++, buf++) {
+                pix = pixmap_row_next(&row, *buf);
+                pbuf = &pix;
+
                 if(x > cx1 && x < cx2) {
                     *buf = (alpha == SGL_ALPHA_MAX ? *pbuf : sgl_color_mixer(*pbuf, *buf, alpha));
                 }
@@ -393,6 +812,22 @@ void sgl_draw_fill_round_rect_pixmap(sgl_surf_t *surf, sgl_area_t *area, sgl_are
  */
 void sgl_draw_rect(sgl_surf_t *surf, sgl_area_t *area, sgl_rect_t *rect, sgl_draw_rect_t *desc)
 {
+    /* the mask is got when shadow is set, the shadow is not drawn without mask */
+    if (desc->shadow_width > 0 && desc->shadow_mask != NULL) {
+        sgl_area_t shadow = {
+            .x1 = rect->x1 - desc->shadow_spread + desc->shadow_ofs_x,
+            .y1 = rect->y1 - desc->shadow_spread + desc->shadow_ofs_y,
+            .x2 = rect->x2 + desc->shadow_spread + desc->shadow_ofs_x,
+            .y2 = rect->y2 + desc->shadow_spread + desc->shadow_ofs_y,
+        };
+        sgl_draw_fill_shadow(surf, area, &shadow, desc->shadow_mask, desc->shadow_color, desc->shadow_alpha);
+    }
+
+    if (desc->pixmap == NULL && desc->gradient != NULL) {
+        sgl_draw_fill_rect_gradient(surf, area, rect, desc->radius, desc->gradient, desc->alpha);
+        return;
+    }
+
     if (desc->radius == 0) {
         if (desc->pixmap == NULL) {
             if (desc->border == 0) {
@@ -423,164 +858,1825 @@ void sgl_draw_rect(sgl_surf_t *surf, sgl_area_t *area, sgl_rect_t *rect, sgl_dra
 
 
 /**
- * @brief Alpha blending table for 4 bpp and 2 bpp
+ * @brief get the bounding area of transformed pixmap
+ * @param desc transformed pixmap description
+ * @param out [out] bounding area of transformed pixmap on surface
+ * @return none
  */
-static const uint8_t opa4_table[16] = {0,  17, 34,  51, 68, 85, 102, 119, 136, 153, 170, 187, 204, 221, 238, 255 };
-static const uint8_t opa2_table[4]  = {0, 85, 170, 255};
+void sgl_draw_transform_get_area(sgl_draw_transform_t *desc, sgl_area_t *out)
+{
+    int64_t sin_z = (int64_t)sgl_sin(desc->angle) * desc->zoom >> 8;
+    int64_t cos_z = (int64_t)sgl_cos(desc->angle) * desc->zoom >> 8;
+    int32_t px[2] = { -desc->pivot_x, desc->pixmap->width - desc->pivot_x };
+    int32_t py[2] = { -desc->pivot_y, desc->pixmap->height - desc->pivot_y };
+    int64_t x, y, x1 = INT64_MAX, y1 = INT64_MAX, x2 = INT64_MIN, y2 = INT64_MIN;
+
+    /* rotate the corners of pixmap, the sine is Q15 */
+    for (int i = 0; i < 4; i++) {
+        x = px[i & 1] * cos_z - py[i >> 1] * sin_z;
+        y = px[i & 1] * sin_z + py[i >> 1] * cos_z;
+        x1 = sgl_min(x1, x);
+        x2 = sgl_max(x2, x);
+        y1 = sgl_min(y1, y);
+        y2 = sgl_max(y2, y);
+    }
+
+    out->x1 = sgl_max(desc->cx + (x1 >> 15) - 1, INT16_MIN);
+    out->y1 = sgl_max(desc->cy + (y1 >> 15) - 1, INT16_MIN);
+    out->x2 = sgl_min(desc->cx + (x2 >> 15) + 1, INT16_MAX);
+    out->y2 = sgl_min(desc->cy + (y2 >> 15) + 1, INT16_MAX);
+}
 
-#if (CONFIG_SGL_FONT_COMPRESSED)
-/**
- * @brief RLE state, refrence LVGL
- */
-typedef enum {
-    RLE_STATE_SINGLE = 0,
-    RLE_STATE_REPEATED,
-    RLE_STATE_COUNTER,
-} sgl_font_rle_state_t;
 
 /**
- * @brief RLE decompress information structure
+ * @brief floor division of 64 bit integer
  */
-typedef struct {
-    uint32_t rdp;
-    const uint8_t * in;
-    uint8_t bpp;
-    uint8_t prev_v;
-    uint8_t count;
-    sgl_font_rle_state_t state;
-} sgl_font_rle_t;
+static inline int64_t fixed_floor_div(int64_t a, int64_t b)
+{
+    int64_t q = a / b;
+    return (q * b != a && ((a < 0) != (b < 0))) ? q - 1 : q;
+}
 
-static sgl_font_rle_t font_rle = {
-    .rdp = 0,
-    .in = NULL,
-    .bpp = 0,
-    .prev_v = 0,
-    .count = 0,
-    .state = RLE_STATE_SINGLE,
-};
 
 /**
- * @brief Get bits from a byte array
- * @param in the byte array
- * @param bit_pos the bit position
- * @param len the bit length
- * @return the bits of a byte
+ * @brief get the range of x that 0 <= p + dp * x < size
+ * @param p position at x = 0, 16.16 fixed point
+ * @param dp step of position, 16.16 fixed point
+ * @param size size of range, 16.16 fixed point
+ * @param x1 [in/out] start of range
+ * @param x2 [in/out] end of range
+ * @return none
  */
-static inline uint8_t get_bits(const uint8_t * in, uint32_t bit_pos, uint8_t len)
+static inline void fixed_span(int64_t p, int32_t dp, int64_t size, int32_t *x1, int32_t *x2)
 {
-    uint8_t bit_mask;
-    switch(len) {
-        case 2:
-            bit_mask = 0x3;
-            break;
-        case 4:
-            bit_mask = 0xF;
-            break;
-        default:
-            bit_mask = (uint16_t)((uint16_t) 1 << len) - 1;
-    }
+    int64_t hi = size - 1;
+    int64_t lo_x, hi_x;
 
-    uint32_t byte_pos = bit_pos >> 3;
-    bit_pos = bit_pos & 0x7;
+    if (dp == 0) {
+        if (p < 0 || p > hi) {
+            *x2 = *x1 - 1;
+        }
+        return;
+    }
 
-    if(bit_pos + len >= 8) {
-        uint16_t in16 = (in[byte_pos] << 8) + in[byte_pos + 1];
-        return (in16 >> (16 - bit_pos - len)) & bit_mask;
+    if (dp > 0) {
+        lo_x = -fixed_floor_div(p, dp);
+        hi_x = fixed_floor_div(hi - p, dp);
     }
     else {
-        return (in[byte_pos] >> (8 - bit_pos - len)) & bit_mask;
+        lo_x = -fixed_floor_div(hi - p, -dp);
+        hi_x = fixed_floor_div(p, -dp);
+    }
+
+    if (lo_x > *x1) {
+        *x1 = (int32_t)sgl_min(lo_x, (int64_t)*x2 + 1);
+    }
+
+    if (hi_x < *x2) {
+        *x2 = (int32_t)sgl_max(hi_x, (int64_t)*x1 - 1);
     }
 }
 
+
+/**
+ * @brief get a texel of pixmap, the position is clamped into pixmap
+ * @param pixmap pointer to pixmap
+ * @param format raw format of pixmap
+ * @param bytes bytes of a pixel
+ * @param x x position of texel
+ * @param y y position of texel
+ * @param alpha [out] alpha of texel
+ * @return color of texel
+ */
+static inline sgl_color_t transform_texel(const sgl_pixmap_t *pixmap, uint8_t format, uint8_t bytes, int32_t x, int32_t y, uint8_t *alpha)
+{
+    x = sgl_max(0, sgl_min(x, (int32_t)pixmap->width - 1));
+    y = sgl_max(0, sgl_min(y, (int32_t)pixmap->height - 1));
+    return pixmap_pixel_to_color(format, &pixmap->bitmap.data[(y * pixmap->width + x) * bytes], alpha);
+}
+
+
 /**
- * @brief Decompress a line of RLE data
- * @param out the decompressed data
- * @param w the width of the decompressed data
+ * @brief draw a zoomed and rotated pixmap
+ * @param surf point to surface
+ * @param area area that you want to draw
+ * @param desc transformed pixmap description
  * @return none
+ * @note the source position is stepped in 16.16 fixed point, and only the pixels in the
+ *       exact row span of transformed pixmap are visited
  */
-static inline void decompress_line(uint8_t *out, int32_t w)
+void sgl_draw_pixmap_transform(sgl_surf_t *surf, sgl_area_t *area, sgl_draw_transform_t *desc)
 {
-    int32_t i;
-    uint8_t v = 0;
-    uint8_t ret = 0;
-    sgl_font_rle_t *rle = &font_rle;
+    const sgl_pixmap_t *pixmap = desc->pixmap;
+    uint8_t format = pixmap_raw_format(pixmap->format);
+    uint8_t bytes = sgl_pixmal_get_bits(pixmap);
+    sgl_area_t bound, clip;
+    sgl_color_t *buf, color, c00, c01, c10, c11;
+    uint8_t a00, a01, a10, a11, color_alpha, fx, fy;
+    int32_t x1, x2;
+    int64_t u_row, v_row;
+
+    SGL_ASSERT(!sgl_pixmap_is_rle(pixmap));
+    if (desc->zoom == 0) {
+        return;
+    }
 
-    for(i = 0; i < w; i++) {
-        if(rle->state == RLE_STATE_SINGLE) {
-            ret = get_bits(rle->in, rle->rdp, rle->bpp);
-            if(rle->rdp != 0 && rle->prev_v == ret) {
-                rle->count = 0;
-                rle->state = RLE_STATE_REPEATED;
-            }
+    sgl_draw_transform_get_area(desc, &bound);
+    if (!sgl_surf_clip(surf, &bound, &clip)) {
+        return;
+    }
 
-            rle->prev_v = ret;
-            rle->rdp += rle->bpp;
-        }
-        else if(rle->state == RLE_STATE_REPEATED) {
-            v = get_bits(rle->in, rle->rdp, 1);
-            rle->count++;
-            rle->rdp += 1;
-            if(v == 1) {
-                ret = rle->prev_v;
-                if(rle->count == 11) {
-                    rle->count = get_bits(rle->in, rle->rdp, 6);
-                    rle->rdp += 6;
-                    if(rle->count != 0) {
-                        rle->state = RLE_STATE_COUNTER;
-                    }
-                    else {
-                        ret = get_bits(rle->in, rle->rdp, rle->bpp);
-                        rle->prev_v = ret;
-                        rle->rdp += rle->bpp;
-                        rle->state = RLE_STATE_SINGLE;
-                    }
-                }
+    if (!sgl_area_selfclip(&clip, area)) {
+        return;
+    }
+
+    /* inverse transform from surface to pixmap, the sine is Q15 and zoom is 8 bit fraction */
+    int32_t sin_q = (sgl_sin(desc->angle) * 512) / desc->zoom;
+    int32_t cos_q = (sgl_cos(desc->angle) * 512) / desc->zoom;
+    int32_t du_dx = cos_q, dv_dx = -sin_q;
+    int32_t du_dy = sin_q, dv_dy = cos_q;
+
+    /* the source position of the center of first pixel in clip area */
+    int32_t dx = ((clip.x1 - desc->cx) * 2) + 1;
+    int32_t dy = ((clip.y1 - desc->cy) * 2) + 1;
+    u_row = ((int64_t)desc->pivot_x * 65536) + (((int64_t)du_dx * dx + (int64_t)du_dy * dy) >> 1);
+    v_row = ((int64_t)desc->pivot_y * 65536) + (((int64_t)dv_dx * dx + (int64_t)dv_dy * dy) >> 1);
+
+    for (int y = clip.y1; y <= clip.y2; y++, u_row += du_dy, v_row += dv_dy) {
+        /* the exact span of this row that the source covers */
+        x1 = 0;
+        x2 = clip.x2 - clip.x1;
+        fixed_span(u_row, du_dx, (int64_t)pixmap->width << 16, &x1, &x2);
+        fixed_span(v_row, dv_dx, (int64_t)pixmap->height << 16, &x1, &x2);
+        if (x1 > x2) {
+            continue;
+        }
+
+        buf = sgl_surf_get_buf(surf, clip.x1 + x1 - surf->x1, y - surf->y1);
+        /* in the span, the source position is in pixmap and fits in 32 bit */
+        int32_t su = (int32_t)(u_row + (int64_t)x1 * du_dx);
+        int32_t sv = (int32_t)(v_row + (int64_t)x1 * dv_dx);
+
+        for (int32_t x = x1; x <= x2; x++, buf++, su += du_dx, sv += dv_dx) {
+            if (desc->filter == SGL_DRAW_FILTER_NEAREST) {
+                color = transform_texel(pixmap, format, bytes, su >> 16, sv >> 16, &color_alpha);
             }
             else {
-                ret = get_bits(rle->in, rle->rdp, rle->bpp);
-                rle->prev_v = ret;
-                rle->rdp += rle->bpp;
-                rle->state = RLE_STATE_SINGLE;
-            }
-        }
-        else if(rle->state == RLE_STATE_COUNTER) {
-            ret = rle->prev_v;
-            rle->count--;
-            if(rle->count == 0) {
-                ret = get_bits(rle->in, rle->rdp, rle->bpp);
-                rle->prev_v = ret;
-                rle->rdp += rle->bpp;
-                rle->state = RLE_STATE_SINGLE;
+                /* sample the four texels around the center of pixel */
+                int32_t u = su - 0x8000, v = sv - 0x8000;
+                int32_t tx = u >> 16, ty = v >> 16;
+                fx = (u >> 8) & 0xFF;
+                fy = (v >> 8) & 0xFF;
+
+                c00 = transform_texel(pixmap, format, bytes, tx, ty, &a00);
+                c10 = transform_texel(pixmap, format, bytes, tx + 1, ty, &a10);
+                c01 = transform_texel(pixmap, format, bytes, tx, ty + 1, &a01);
+                c11 = transform_texel(pixmap, format, bytes, tx + 1, ty + 1, &a11);
+
+                color = sgl_color_mixer(sgl_color_mixer(c11, c01, fx), sgl_color_mixer(c10, c00, fx), fy);
+                a00 = a00 + (((a10 - a00) * fx) >> 8);
+                a01 = a01 + (((a11 - a01) * fx) >> 8);
+                color_alpha = a00 + (((a01 - a00) * fy) >> 8);
+                if (a00 == SGL_ALPHA_MAX && a01 == SGL_ALPHA_MAX) {
+                    color_alpha = SGL_ALPHA_MAX;
+                }
             }
-        }
-        if (out != NULL) {
-            out[i] = ret;
+
+            color = (color_alpha == SGL_ALPHA_MAX ? color : sgl_color_mixer(color, *buf, color_alpha));
+            *buf = (desc->alpha == SGL_ALPHA_MAX ? color : sgl_color_mixer(color, *buf, desc->alpha));
         }
     }
 }
 
+
 /**
- * @brief Initialize the RLE decompression state
- * @param in Pointer to the input data
- * @param bpp Bits per pixel of the input data
+ * @brief half width of a circle row, it is the max |dx| that dx^2 + dy^2 < limit,
+ *        the rows above and below center, and the left and right side share it
+ */
+typedef struct {
+    int32_t limit;
+    int32_t x;
+} sgl_circle_edge_t;
+
+
+/**
+ * @brief init the half width of circle at the first row
+ * @param edge circle edge
+ * @param limit squared radius, the pixel is inside if its squared distance is less than it
+ * @param dy2 squared y offset of row from center
  * @return none
  */
-static inline void font_rle_init(const uint8_t * in, uint8_t bpp)
+static inline void circle_edge_init(sgl_circle_edge_t *edge, int32_t limit, int32_t dy2)
 {
-    font_rle.in = in;
-    font_rle.bpp = bpp;
-    font_rle.state = RLE_STATE_SINGLE;
-    font_rle.rdp = 0;
-    font_rle.prev_v = 0;
-    font_rle.count = 0;
+    edge->limit = limit;
+    edge->x = limit > dy2 ? sgl_sqrt(limit - dy2 - 1) : -1;
 }
-#endif // (!CONFIG_SGL_FONT_COMPRESSED)
 
 
 /**
- * @brief Draw a character on the surface with alpha blending
- * @param surf Pointer to the surface where the character will be drawn
- * @param area Pointer to the area where the character will be drawn
+ * @brief step the half width of circle to next row by integer midpoint stepping
+ * @param edge circle edge
+ * @param dy2 squared y offset of row from center
+ * @return half width of row, -1 means the row is out of circle
+ */
+static inline int32_t circle_edge_step(sgl_circle_edge_t *edge, int32_t dy2)
+{
+    while (edge->x >= 0 && sgl_pow2(edge->x) + dy2 >= edge->limit) {
+        edge->x --;
+    }
+
+    while (sgl_pow2(edge->x + 1) + dy2 < edge->limit) {
+        edge->x ++;
+    }
+
+    return edge->x;
+}
+
+
+/**
+ * @brief fill a span of circle row with color
+ * @param surf surface
+ * @param clip clip area
+ * @param y y coordinate of row
+ * @param x1 x start coordinate of span
+ * @param x2 x end coordinate of span
+ * @param color color of span
+ * @param alpha alpha of span
+ * @return none
+ */
+static inline void circle_fill_span(sgl_surf_t *surf, sgl_area_t *clip, int32_t y, int32_t x1, int32_t x2, sgl_color_t color, uint8_t alpha)
+{
+    sgl_color_t *buf;
+
+    x1 = sgl_max(x1, clip->x1);
+    x2 = sgl_min(x2, clip->x2);
+    if (x1 > x2) {
+        return;
+    }
+
+    buf = sgl_surf_get_buf(surf, x1 - surf->x1, y - surf->y1);
+
+    for (int32_t x = x1; x <= x2; x++, buf++) {
+        *buf = (alpha == SGL_ALPHA_MAX ? color : sgl_color_mixer(color, *buf, alpha));
+    }
+}
+
+
+/**
+ * @brief blend an anti-aliased edge span of circle row, it is 1 or 2 pixels mostly
+ * @param surf surface
+ * @param clip clip area
+ * @param y y coordinate of row
+ * @param x1 x start coordinate of span
+ * @param x2 x end coordinate of span
+ * @param cx x coordinate of center
+ * @param dy2 squared y offset of row from center
+ * @param color color of edge
+ * @param bg background color of edge, NULL means the surface
+ * @param inner true if it is the inner edge, the color is inside
+ * @param alpha alpha of edge
+ * @return none
+ */
+static inline void circle_edge_span(sgl_surf_t *surf, sgl_area_t *clip, int32_t y, int32_t x1, int32_t x2, int32_t cx, int32_t dy2,
+                                    sgl_color_t color, const sgl_color_t *bg, bool inner, uint8_t alpha)
+{
+    sgl_color_t *buf, pix;
+    uint8_t edge_alpha;
+
+    x1 = sgl_max(x1, clip->x1);
+    x2 = sgl_min(x2, clip->x2);
+    if (x1 > x2) {
+        return;
+    }
+
+    buf = sgl_surf_get_buf(surf, x1 - surf->x1, y - surf->y1);
+
+    for (int32_t x = x1; x <= x2; x++, buf++) {
+        edge_alpha = sgl_sqrt_error(sgl_pow2(x - cx) + dy2);
+        edge_alpha = inner ? edge_alpha : SGL_ALPHA_MAX - edge_alpha;
+        pix = sgl_color_mixer(color, bg ? *bg : *buf, edge_alpha);
+        *buf = (alpha == SGL_ALPHA_MAX ? pix : sgl_color_mixer(pix, *buf, alpha));
+    }
+}
+
+
+/**
+ * @brief Draw a circle
+ * @param surf Surface
+ * @param area Area of the circle
+ * @param cx X coordinate of the center
+ * @param cy Y coordinate of the center
+ * @param radius Radius of the circle
+ * @param color Color of the circle
+ * @param alpha Alpha of the circle
+ * @return none
+ * @note the half widths of rows are stepped, so only the edge pixels are blended one by one
+ */
+void sgl_draw_fill_circle(sgl_surf_t *surf, sgl_area_t *area, int16_t cx, int16_t cy, int16_t radius, sgl_color_t color, uint8_t alpha)
+{
+    sgl_circle_edge_t outer, solid;
+    int32_t dy2, xo, xs;
+    sgl_area_t clip, rect = {
+        .x1 = cx - radius,
+        .y1 = cy - radius,
+        .x2 = cx + radius,
+        .y2 = cy + radius,
+    };
+
+    if (!sgl_surf_clip(surf, &rect, &clip)) {
+        return;
+    }
+
+    if (!sgl_area_selfclip(&clip, area)) {
+        return;
+    }
+
+    dy2 = sgl_pow2(clip.y1 - cy);
+    circle_edge_init(&outer, sgl_pow2(radius + 1), dy2);
+    circle_edge_init(&solid, sgl_pow2(radius), dy2);
+
+    for (int y = clip.y1; y <= clip.y2; y++) {
+        dy2 = sgl_pow2(y - cy);
+        xo = circle_edge_step(&outer, dy2);
+        xs = circle_edge_step(&solid, dy2);
+
+        circle_edge_span(surf, &clip, y, cx - xo, cx - xs - 1, cx, dy2, color, NULL, false, alpha);
+        circle_fill_span(surf, &clip, y, cx - xs, cx + xs, color, alpha);
+        circle_edge_span(surf, &clip, y, cx + sgl_max(xs, 0) + 1, cx + xo, cx, dy2, color, NULL, false, alpha);
+    }
+}
+
+
+/**
+ * @brief Draw a circle with pixmap and alpha
+ * @param surf Surface
+ * @param area Area of the circle
+ * @param cx X coordinate of the center
+ * @param cy Y coordinate of the center
+ * @param radius Radius of the circle
+ * @param pixmap Pixmap of image
+ * @param alpha Alpha of the circle
+ * @param px  center X coordinate of the pixmap
+ * @param py  center Y coordinate of the pixmap
+ * @return none
+ * @note the pixels out of pixmap are not drawn
+ */
+void sgl_draw_fill_circle_pixmap(sgl_surf_t *surf, sgl_area_t *area, int16_t cx, int16_t cy, int16_t radius, const sgl_pixmap_t *pixmap, uint8_t alpha, int16_t px, int16_t py)
+{
+    sgl_circle_edge_t outer, solid;
+    sgl_pixmap_row_t row;
+    sgl_color_t *buf, pix;
+    int32_t dy2, xo, xs, x1, x2;
+    uint8_t edge_alpha;
+    sgl_area_t clip, rect = {
+        .x1 = cx - radius,
+        .y1 = cy - radius,
+        .x2 = cx + radius,
+        .y2 = cy + radius,
+    };
+    sgl_area_t pick = {
+        .x1 = cx - px,
+        .y1 = cy - py,
+        .x2 = cx - px + pixmap->width - 1,
+        .y2 = cy - py + pixmap->height - 1,
+    };
+
+    if (!sgl_surf_clip(surf, &rect, &clip)) {
+        return;
+    }
+
+    if (!sgl_area_selfclip(&clip, area)) {
+        return;
+    }
+
+    if (!sgl_area_selfclip(&clip, &pick)) {
+        return;
+    }
+
+    dy2 = sgl_pow2(clip.y1 - cy);
+    circle_edge_init(&outer, sgl_pow2(radius + 1), dy2);
+    circle_edge_init(&solid, sgl_pow2(radius), dy2);
+
+    for (int y = clip.y1; y <= clip.y2; y++) {
+        dy2 = sgl_pow2(y - cy);
+        xo = circle_edge_step(&outer, dy2);
+        xs = circle_edge_step(&solid, dy2);
+
+        x1 = sgl_max(cx - xo, clip.x1);
+        x2 = sgl_min(cx + xo, clip.x2);
+        if (x1 > x2) {
+            continue;
+        }
+
+        buf = sgl_surf_get_buf(surf, x1 - surf->x1, y - surf->y1);
+        pixmap_row_seek(&row, pixmap, x1 - pick.x1, y - pick.y1, x2 - x1 + 1);
+
+        for (int32_t x = x1; x <= x2; x++, buf++) {
+            /* the solid part of row is blitted at once */
+            if (x >= cx - xs && x <= cx + xs) {
+                int32_t n = sgl_min(cx + xs, x2) - x + 1;
+                pixmap_row_blit(&row, buf, n, alpha);
+                buf += n - 1;
+                x += n - 1;
+                continue;
+            }
+
+            pix = pixmap_row_next(&row, *buf);
+            edge_alpha = SGL_ALPHA_MAX - sgl_sqrt_error(sgl_pow2(x - cx) + dy2);
+            pix = sgl_color_mixer(pix, *buf, edge_alpha);
+            *buf = (alpha == SGL_ALPHA_MAX ? pix : sgl_color_mixer(pix, *buf, alpha));
+        }
+    }
+}
+
+
+/**
+ * @brief Draw a circle with alpha and border
+ * @param surf Surface
+ * @param area Area of the circle
+ * @param cx X coordinate of the center
+ * @param cy Y coordinate of the center
+ * @param radius Radius of the circle
+ * @param color Color of the circle
+ * @param border_color Color of the border
+ * @param border_width Width of the border
+ * @param alpha Alpha of the circle
+ * @return none
+ */
+void sgl_draw_fill_circle_with_border(sgl_surf_t *surf, sgl_area_t *area, int16_t cx, int16_t cy, int16_t radius, sgl_color_t color, sgl_color_t border_color, int16_t border_width, uint8_t alpha)
+{
+    int32_t radius_in = sgl_max(radius - border_width + 1, 0);
+    sgl_circle_edge_t outer, solid, inner, fill;
+    int32_t dy2, xo, xs, xi, xf;
+    sgl_area_t clip, rect = {
+        .x1 = cx - radius,
+        .y1 = cy - radius,
+        .x2 = cx + radius,
+        .y2 = cy + radius,
+    };
+
+    if (!sgl_surf_clip(surf, &rect, &clip)) {
+        return;
+    }
+
+    if (!sgl_area_selfclip(&clip, area)) {
+        return;
+    }
+
+    dy2 = sgl_pow2(clip.y1 - cy);
+    circle_edge_init(&outer, sgl_pow2(radius + 1), dy2);
+    circle_edge_init(&solid, sgl_pow2(radius) + 1, dy2);
+    circle_edge_init(&inner, sgl_pow2(radius_in), dy2);
+    circle_edge_init(&fill, sgl_pow2(radius_in - 1), dy2);
+
+    for (int y = clip.y1; y <= clip.y2; y++) {
+        dy2 = sgl_pow2(y - cy);
+        xo = circle_edge_step(&outer, dy2);
+        xs = circle_edge_step(&solid, dy2);
+        xf = sgl_min(circle_edge_step(&fill, dy2), xo);
+        xi = sgl_max(sgl_min(circle_edge_step(&inner, dy2), xo), xf);
+
+        /* from outside to center: outer edge, border, inner edge and fill, the center pixel
+         * belongs to the left side
+         */
+        xs = sgl_max(xs, xi);
+        circle_edge_span(surf, &clip, y, cx - xo, cx - xs - 1, cx, dy2, border_color, NULL, false, alpha);
+        circle_fill_span(surf, &clip, y, cx - xs, cx - xi - 1, border_color, alpha);
+        circle_edge_span(surf, &clip, y, cx - xi, cx - xf - 1, cx, dy2, border_color, &color, true, alpha);
+        circle_fill_span(surf, &clip, y, cx - xf, cx + xf, color, alpha);
+        circle_edge_span(surf, &clip, y, cx + sgl_max(xf, 0) + 1, cx + xi, cx, dy2, border_color, &color, true, alpha);
+        circle_fill_span(surf, &clip, y, cx + sgl_max(xi, 0) + 1, cx + xs, border_color, alpha);
+        circle_edge_span(surf, &clip, y, cx + sgl_max(xs, 0) + 1, cx + xo, cx, dy2, border_color, NULL, false, alpha);
+    }
+}
+
+
+/**
+ * @brief draw task, the task contains the draw information and canvas
+ * @param surf surface pointer
+ * @param area the area of the task
+ * @param desc the draw information
+ * @return none
+ */
+void sgl_draw_circle(sgl_surf_t *surf, sgl_area_t *area, sgl_draw_circle_t *desc)
+{
+    if (desc->pixmap == NULL) {
+        if (desc->border) {
+            sgl_draw_fill_circle_with_border(surf, area, desc->cx, desc->cy, desc->radius, desc->color, desc->border_color, desc->border, desc->alpha);
+        }
+        else {
+            sgl_draw_fill_circle(surf, area, desc->cx, desc->cy, desc->radius, desc->color, desc->alpha);
+        }
+    }
+    else {
+        sgl_draw_fill_circle_pixmap(surf, area, desc->cx, desc->cy, desc->radius, desc->pixmap, desc->alpha, desc->pixmap->width / 2, desc->pixmap->height / 2);
+    }
+}
+
+
+/**
+ * @brief draw a ring on surface with alpha
+ * @param surf: pointer of surface
+ * @param area: pointer of area
+ * @param cx: ring center x
+ * @param cy: ring center y
+ * @param radius_in: ring inner radius
+ * @param radius_out: ring outer radius
+ * @param color: ring color
+ * @param alpha: ring alpha
+ * @return none
+ * @note the hole of ring is skipped, and only the edge pixels are blended one by one
+ */
+void sgl_draw_fill_ring(sgl_surf_t *surf, sgl_area_t *area, int16_t cx, int16_t cy, int16_t radius_in, int16_t radius_out, sgl_color_t color, uint8_t alpha)
+{
+    sgl_circle_edge_t outer, solid, inner, hole;
+    int32_t dy2, xo, xs, xi, xh;
+    sgl_area_t clip, rect = {
+        .x1 = cx - radius_out,
+        .y1 = cy - radius_out,
+        .x2 = cx + radius_out,
+        .y2 = cy + radius_out,
+    };
+
+    if (!sgl_surf_clip(surf, &rect, &clip)) {
+        return;
+    }
+
+    if (!sgl_area_selfclip(&clip, area)) {
+        return;
+    }
+
+    /* no hole and no inner edge if inner radius is zero */
+    dy2 = sgl_pow2(clip.y1 - cy);
+    circle_edge_init(&outer, sgl_pow2(radius_out + 1), dy2);
+    circle_edge_init(&solid, sgl_pow2(radius_out) + 1, dy2);
+    circle_edge_init(&inner, radius_in > 0 ? sgl_pow2(radius_in) : 0, dy2);
+    circle_edge_init(&hole, radius_in > 0 ? sgl_pow2(radius_in - 1) : 0, dy2);
+
+    for (int y = clip.y1; y <= clip.y2; y++) {
+        dy2 = sgl_pow2(y - cy);
+        xo = circle_edge_step(&outer, dy2);
+        xs = circle_edge_step(&solid, dy2);
+        xi = sgl_min(circle_edge_step(&inner, dy2), xo);
+        xh = sgl_min(circle_edge_step(&hole, dy2), xo);
+
+        /* from outside to center: outer edge, solid and inner edge, the inner edge comes first,
+         * and the center pixel belongs to the left side
+         */
+        xs = sgl_max(xs, xi);
+        circle_edge_span(surf, &clip, y, cx - xo, cx - xs - 1, cx, dy2, color, NULL, false, alpha);
+        circle_fill_span(surf, &clip, y, cx - xs, cx - xi - 1, color, alpha);
+        circle_edge_span(surf, &clip, y, cx - xi, cx - xh - 1, cx, dy2, color, NULL, true, alpha);
+        circle_edge_span(surf, &clip, y, cx + sgl_max(xh, 0) + 1, cx + xi, cx, dy2, color, NULL, true, alpha);
+        circle_fill_span(surf, &clip, y, cx + sgl_max(xi, 0) + 1, cx + xs, color, alpha);
+        circle_edge_span(surf, &clip, y, cx + sgl_max(xs, 0) + 1, cx + xo, cx, dy2, color, NULL, false, alpha);
+    }
+}
+
+
+/**
+ * @brief build the color table of gradient
+ * @param grad pointer to gradient
+ * @param type type of gradient, SGL_GRADIENT_LINEAR or SGL_GRADIENT_RADIAL
+ * @param angle direction of linear gradient in degree, 0 is from left to right, 90 is from top to bottom
+ * @param start_color color at start of linear gradient or at center of radial gradient
+ * @param end_color color at end of linear gradient or at the farthest corner of radial gradient
+ * @return none
+ */
+void sgl_gradient_init(sgl_gradient_t *grad, uint8_t type, int16_t angle, sgl_color_t start_color, sgl_color_t end_color)
+{
+    sgl_color_t color = start_color;
+
+    grad->type = type;
+    grad->angle = angle;
+
+    /* interpolate every channel in its own depth, so the table is not limited by the mixer */
+    for (int i = 0; i < SGL_GRADIENT_LUT_SIZE; i++) {
+        color.ch.red = start_color.ch.red + ((int)end_color.ch.red - start_color.ch.red) * i / (SGL_GRADIENT_LUT_SIZE - 1);
+        color.ch.green = start_color.ch.green + ((int)end_color.ch.green - start_color.ch.green) * i / (SGL_GRADIENT_LUT_SIZE - 1);
+        color.ch.blue = start_color.ch.blue + ((int)end_color.ch.blue - start_color.ch.blue) * i / (SGL_GRADIENT_LUT_SIZE - 1);
+        grad->lut[i] = color;
+    }
+}
+
+
+/**
+ * @brief gradient drawing context, the position is in double pixel relative to center of rect,
+ *        so that the center of pixel is always integer
+ */
+typedef struct {
+    const sgl_gradient_t *grad;
+    int16_t cx2;
+    int16_t cy2;
+    int16_t x1;
+    int16_t y1;
+    /* linear: table index at the first pixel of rect and its steps, 16.16 fixed point */
+    int32_t base;
+    int32_t step_x;
+    int32_t step_y;
+    /* radial: doubled distance from center to the farthest corner, and its square */
+    int32_t dmax;
+    int64_t dmax2;
+} sgl_gradient_ctx_t;
+
+
+/**
+ * @brief set up gradient context for rect
+ * @param ctx [out] gradient context
+ * @param grad pointer to gradient
+ * @param rect rect that gradient covers
+ * @return none
+ */
+static void gradient_ctx_init(sgl_gradient_ctx_t *ctx, const sgl_gradient_t *grad, sgl_area_t *rect)
+{
+    int32_t w2 = rect->x2 - rect->x1, h2 = rect->y2 - rect->y1;
+    int32_t cos = sgl_cos(grad->angle), sin = sgl_sin(grad->angle);
+    int64_t pmax;
+
+    ctx->grad = grad;
+    ctx->cx2 = rect->x1 + rect->x2;
+    ctx->cy2 = rect->y1 + rect->y2;
+    ctx->x1 = rect->x1;
+    ctx->y1 = rect->y1;
+
+    if (grad->type == SGL_GRADIENT_RADIAL) {
+        ctx->dmax2 = (int64_t)sgl_pow2(w2) + sgl_pow2(h2);
+        ctx->dmax = sgl_sqrt((uint32_t)ctx->dmax2);
+        return;
+    }
+
+    /* the projection of rect on the direction is [-pmax, pmax], it is mapped to [0, 255] */
+    pmax = (int64_t)sgl_abs(w2 * cos) + sgl_abs(h2 * sin);
+    if (pmax == 0) {
+        ctx->base = ctx->step_x = ctx->step_y = 0;
+        return;
+    }
+
+    ctx->step_x = (int32_t)((int64_t)cos * ((SGL_GRADIENT_LUT_SIZE - 1) << 16) / pmax);
+    ctx->step_y = (int32_t)((int64_t)sin * ((SGL_GRADIENT_LUT_SIZE - 1) << 16) / pmax);
+    ctx->base = (int32_t)((pmax - (int64_t)w2 * cos - (int64_t)h2 * sin) * ((SGL_GRADIENT_LUT_SIZE - 1) << 15) / pmax);
+}
+
+
+/**
+ * @brief get the table index of radial gradient at a doubled squared distance
+ * @param ctx gradient context
+ * @param d2 doubled squared distance from center
+ * @param index index near the result, it is stepped from
+ * @return table index
+ * @note the index i satisfies i * dmax <= 255 * d < (i + 1) * dmax, which is compared in
+ *       square, so it is stepped from the index of neighbour pixel without square root
+ */
+static inline int32_t gradient_radial_step(sgl_gradient_ctx_t *ctx, int64_t d2, int32_t index)
+{
+    int64_t k = d2 * sgl_pow2(SGL_GRADIENT_LUT_SIZE - 1);
+
+    while (index < SGL_GRADIENT_LUT_SIZE - 1 && k >= sgl_pow2((int64_t)index + 1) * ctx->dmax2) {
+        index ++;
+    }
+
+    while (index > 0 && k < sgl_pow2((int64_t)index) * ctx->dmax2) {
+        index --;
+    }
+
+    return index;
+}
+
+
+/**
+ * @brief draw a span of gradient, the color is stepped from pixel to pixel
+ * @param ctx gradient context
+ * @param buf first pixel of span in surface
+ * @param x x start coordinate of span
+ * @param y y coordinate of span
+ * @param n number of pixels
+ * @param alpha alpha of span
+ * @return none
+ */
+static void gradient_span(sgl_gradient_ctx_t *ctx, sgl_color_t *buf, int32_t x, int32_t y, int32_t n, uint8_t alpha)
+{
+    const sgl_color_t *lut = ctx->grad->lut;
+    sgl_color_t color;
+
+    if (ctx->grad->type == SGL_GRADIENT_RADIAL) {
+        int32_t dx = 2 * x - ctx->cx2, dy = 2 * y - ctx->cy2;
+        int64_t d2 = sgl_pow2(dx) + sgl_pow2(dy);
+        int32_t index = ctx->dmax ? sgl_min(sgl_sqrt((uint32_t)d2) * (SGL_GRADIENT_LUT_SIZE - 1) / ctx->dmax, SGL_GRADIENT_LUT_SIZE - 1) : 0;
+
+        for (; n > 0; n--, buf++, d2 += 4 * dx + 4, dx += 2) {
+            index = ctx->dmax2 ? gradient_radial_step(ctx, d2, index) : 0;
+            *buf = (alpha == SGL_ALPHA_MAX ? lut[index] : sgl_color_mixer(lut[index], *buf, alpha));
+        }
+        return;
+    }
+
+    /* the index is clamped, since the stepping error may go out of table at the ends */
+    int32_t t = ctx->base + (x - ctx->x1) * ctx->step_x + (y - ctx->y1) * ctx->step_y;
+    for (; n > 0; n--, buf++, t += ctx->step_x) {
+        color = lut[sgl_max(0, sgl_min(t >> 16, SGL_GRADIENT_LUT_SIZE - 1))];
+        *buf = (alpha == SGL_ALPHA_MAX ? color : sgl_color_mixer(color, *buf, alpha));
+    }
+}
+
+
+/**
+ * @brief fill a rect or round rect with gradient and alpha
+ * @param surf point to surface
+ * @param area area of rectangle that you want to draw
+ * @param rect point to rectangle that you want to draw
+ * @param radius radius of round, 0 means no round
+ * @param grad gradient of rectangle
+ * @param alpha alpha of rectangle
+ * @return none
+ * @note every row is split into the solid span and the anti-aliased corner pixels, and the
+ *       colors of span are stepped from the color table of gradient
+ */
+void sgl_draw_fill_rect_gradient(sgl_surf_t *surf, sgl_area_t *area, sgl_area_t *rect, int16_t radius, const sgl_gradient_t *grad, uint8_t alpha)
+{
+    sgl_area_t clip;
+    sgl_gradient_ctx_t ctx;
+    sgl_circle_edge_t outer, solid;
+    sgl_color_t *buf, color;
+    int32_t dy2, xo, xs, x1, x2, cy, edge_x1, edge_x2;
+    int32_t cx1, cx2, cy1, cy2;
+    uint8_t edge_alpha;
+
+    if (!sgl_surf_clip(surf, rect, &clip)) {
+        return;
+    }
+
+    if (!sgl_area_selfclip(&clip, area)) {
+        return;
+    }
+
+    gradient_ctx_init(&ctx, grad, rect);
+    radius = sgl_max(0, sgl_min(radius, sgl_min(rect->x2 - rect->x1, rect->y2 - rect->y1) / 2));
+    cx1 = rect->x1 + radius;
+    cx2 = rect->x2 - radius;
+    cy1 = rect->y1 + radius;
+    cy2 = rect->y2 - radius;
+
+    dy2 = sgl_pow2(clip.y1 - (clip.y1 > cy1 ? cy2 : cy1));
+    circle_edge_init(&outer, sgl_pow2(radius + 1), dy2);
+    circle_edge_init(&solid, sgl_pow2(radius), dy2);
+
+    for (int y = clip.y1; y <= clip.y2; y++) {
+        /* the rows between corners are solid */
+        if (radius == 0 || (y > cy1 && y < cy2)) {
+            buf = sgl_surf_get_buf(surf, clip.x1 - surf->x1, y - surf->y1);
+            gradient_span(&ctx, buf, clip.x1, y, clip.x2 - clip.x1 + 1, alpha);
+            continue;
+        }
+
+        cy = y > cy1 ? cy2 : cy1;
+        dy2 = sgl_pow2(y - cy);
+        xo = circle_edge_step(&outer, dy2);
+        xs = circle_edge_step(&solid, dy2);
+
+        x1 = sgl_max(clip.x1, cx1 - xs);
+        x2 = sgl_min(clip.x2, cx2 + xs);
+        if (x1 <= x2) {
+            buf = sgl_surf_get_buf(surf, x1 - surf->x1, y - surf->y1);
+            gradient_span(&ctx, buf, x1, y, x2 - x1 + 1, alpha);
+        }
+
+        /* the anti-aliased pixels of left and right corner, the right one is after left one */
+        for (int k = 0; k < 2; k++) {
+            int32_t ccx = k ? cx2 : cx1;
+            edge_x1 = sgl_max(clip.x1, k ? sgl_max(cx2 + xs + 1, cx1 + 1) : cx1 - xo);
+            edge_x2 = sgl_min(clip.x2, k ? cx2 + xo : cx1 - xs - 1);
+
+            for (int32_t x = edge_x1; x <= edge_x2; x++) {
+                buf = sgl_surf_get_buf(surf, x - surf->x1, y - surf->y1);
+                edge_alpha = SGL_ALPHA_MAX - sgl_sqrt_error(sgl_pow2(x - ccx) + dy2);
+                gradient_span(&ctx, &color, x, y, 1, SGL_ALPHA_MAX);
+                color = sgl_color_mixer(color, *buf, edge_alpha);
+                *buf = (alpha == SGL_ALPHA_MAX ? color : sgl_color_mixer(color, *buf, alpha));
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief get the coverage of shadow shape at a corner
+ * @param sx x offset from the side of shape
+ * @param sy y offset from the top of shape
+ * @param radius radius of corner
+ * @return coverage of shape
+ */
+static inline uint8_t shadow_shape(int32_t sx, int32_t sy, int32_t radius)
+{
+    int32_t r2;
+
+    if (sx < 0 || sy < 0) {
+        return SGL_ALPHA_MIN;
+    }
+
+    if (sx >= radius || sy >= radius) {
+        return SGL_ALPHA_MAX;
+    }
+
+    r2 = sgl_pow2(sx - radius) + sgl_pow2(sy - radius);
+    if (r2 < sgl_pow2(radius)) {
+        return SGL_ALPHA_MAX;
+    }
+    else if (r2 < sgl_pow2(radius + 1)) {
+        return SGL_ALPHA_MAX - sgl_sqrt_error(r2);
+    }
+
+    return SGL_ALPHA_MIN;
+}
+
+
+/**
+ * @brief get the blurred corner mask of shadow, the mask of same radius and blur is shared
+ * @param radius radius of corner, it should be got by sgl_draw_rect_shadow_radius()
+ * @param blur half width of box blur
+ * @return pointer to mask, NULL means out of memory
+ * @note it should be called when the shadow is set, so drawing never allocates, and the mask
+ *       should be released by sgl_draw_shadow_mask_put(). the corner shape is blurred by a
+ *       horizontal and a vertical box pass, the mask covers from blur out of shape to
+ *       radius + blur into shape. the rows of horizontal pass are summed per column as they
+ *       are made, and kept in the mask rows until they leave the vertical window, so the
+ *       transient buffer is one row and the column sums
+ */
+sgl_shadow_mask_t* sgl_draw_shadow_mask_get(int16_t radius, uint8_t blur)
+{
+    int32_t size = radius + 2 * blur + 1, n = size + 2 * blur, b = 2 * blur + 1;
+    sgl_shadow_mask_t *mask;
+    uint32_t sum;
+    uint16_t *col;
+    uint8_t *tmp, *line, h;
+
+    for (mask = sgl_system.shadow_mask; mask != NULL; mask = mask->next) {
+        if (mask->radius == radius && mask->blur == blur) {
+            mask->ref ++;
+            return mask;
+        }
+    }
+
+    mask = sgl_malloc_hint(sizeof(sgl_shadow_mask_t) + size * size, SGL_MM_HEAP_BULK);
+    /* the column sum is less than 255 * 255, because blur is less than 128 */
+    col = sgl_malloc(size * sizeof(uint16_t) + size);
+    if (mask == NULL || col == NULL) {
+        SGL_LOG_ERROR("sgl_draw_shadow_mask_get: malloc failed");
+        sgl_free(mask);
+        sgl_free(col);
+        return NULL;
+    }
+
+    tmp = (uint8_t*)(col + size);
+    memset(col, 0, size * sizeof(uint16_t));
+
+    for (int32_t j = 0; j < n; j++) {
+        /* horizontal pass, the row j of shape is at y offset j - 2 * blur, it's kept in
+         * mask row j until the output row j is made, the rows out of mask are not kept
+         */
+        line = j < size ? &mask->mask[j * size] : tmp;
+        sum = 0;
+        for (int32_t i = 0; i < b - 1; i++) {
+            sum += shadow_shape(i - 2 * blur, j - 2 * blur, radius);
+        }
+
+        for (int32_t u = 0; u < size; u++) {
+            sum += shadow_shape(u + b - 1 - 2 * blur, j - 2 * blur, radius);
+            line[u] = (sum + b / 2) / b;
+            sum -= shadow_shape(u - 2 * blur, j - 2 * blur, radius);
+        }
+
+        /* vertical pass, the window of output row j - b + 1 is full after row j is added,
+         * then the input row j - b + 1 leaves window, so it's replaced by output row
+         */
+        for (int32_t u = 0; u < size; u++) {
+            col[u] += line[u];
+        }
+
+        if (j >= b - 1) {
+            line = &mask->mask[(j - b + 1) * size];
+            for (int32_t u = 0; u < size; u++) {
+                h = line[u];
+                line[u] = (col[u] + b / 2) / b;
+                col[u] -= h;
+            }
+        }
+    }
+
+    sgl_free(col);
+
+    mask->ref = 1;
+    mask->radius = radius;
+    mask->blur = blur;
+    mask->size = size;
+    mask->next = sgl_system.shadow_mask;
+    sgl_system.shadow_mask = mask;
+    return mask;
+}
+
+
+/**
+ * @brief release the blurred corner mask of shadow, it's freed if no shadow uses it
+ * @param mask point to mask, NULL means no mask
+ * @return none
+ */
+void sgl_draw_shadow_mask_put(sgl_shadow_mask_t *mask)
+{
+    sgl_shadow_mask_t **p = &sgl_system.shadow_mask;
+
+    if (mask == NULL || --mask->ref > 0) {
+        return;
+    }
+
+    while (*p != mask) {
+        p = &(*p)->next;
+    }
+
+    *p = mask->next;
+    sgl_free(mask);
+}
+
+
+/**
+ * @brief get the scale of shadow coverage by the farther side, it's used if the shape is
+ *        thinner than two masks, where the blur of farther side reaches the pixel
+ * @param profile 1-D coverage of straight side, it's the last row of mask
+ * @param near distance from the nearer side of bound
+ * @param far distance from the farther side of bound
+ * @param last last index of profile
+ * @return scale of coverage, 256 means the farther side has no effect
+ * @note the 1-D coverage of both sides is near + far - max, it's scaled to the coverage
+ *       of nearer side, so the corner mask is attenuated in the same ratio
+ */
+static inline uint32_t shadow_far_scale(const uint8_t *profile, int32_t near, int32_t far, int32_t last)
+{
+    int32_t pn, both;
+
+    if (far >= last) {
+        return 256;
+    }
+
+    pn = profile[sgl_min(near, last)];
+    both = pn + profile[far] - SGL_ALPHA_MAX;
+    if (pn == 0 || both <= 0) {
+        return 0;
+    }
+
+    return ((uint32_t)both << 8) / pn;
+}
+
+
+/**
+ * @brief draw the blurred shadow of a round rectangle with alpha
+ * @param surf point to surface
+ * @param area area of shadow that you want to draw
+ * @param rect point to shape of shadow, the blur goes out of it by blur of mask
+ * @param mask blurred corner mask of shadow, it's got by sgl_draw_shadow_mask_get()
+ * @param color color of shadow
+ * @param alpha alpha of shadow
+ * @return none
+ * @note the corner mask is mirrored to four corners, the straight edges use the last row
+ *       of mask as 1-D profile, and the inside is filled in bulk. every pixel is blended once.
+ *       if the shape is thinner than two masks, the coverage is attenuated by the farther side
+ */
+void sgl_draw_fill_shadow(sgl_surf_t *surf, sgl_area_t *area, sgl_area_t *rect, const sgl_shadow_mask_t *mask, sgl_color_t color, uint8_t alpha)
+{
+    uint8_t blur = mask->blur;
+    sgl_area_t clip, bound = {
+        .x1 = rect->x1 - blur,
+        .y1 = rect->y1 - blur,
+        .x2 = rect->x2 + blur,
+        .y2 = rect->y2 + blur,
+    };
+    sgl_color_t *buf;
+    const uint8_t *row, *profile;
+    int32_t last, ux, uy, x2;
+    uint32_t alpha_x, alpha_y;
+    uint8_t mix;
+
+    if (alpha == SGL_ALPHA_MIN) {
+        return;
+    }
+
+    if (!sgl_surf_clip(surf, &bound, &clip)) {
+        return;
+    }
+
+    if (!sgl_area_selfclip(&clip, area)) {
+        return;
+    }
+
+    last = mask->size - 1;
+    profile = &mask->mask[last * mask->size];
+    for (int y = clip.y1; y <= clip.y2; y++) {
+        /* the nearer side of rect is used, so the corner mask is mirrored */
+        uy = sgl_min(y - bound.y1, bound.y2 - y);
+        row = &mask->mask[sgl_min(uy, last) * mask->size];
+        alpha_y = (alpha * shadow_far_scale(profile, uy, bound.y2 - bound.y1 - uy, last)) >> 8;
+        buf = sgl_surf_get_buf(surf, clip.x1 - surf->x1, y - surf->y1);
+
+        for (int32_t x = clip.x1; x <= clip.x2; x++, buf++) {
+            ux = sgl_min(x - bound.x1, bound.x2 - x);
+
+            /* the inside of row has the same coverage */
+            if (ux >= last) {
+                mix = (row[last] * alpha_y + SGL_ALPHA_MAX) >> 8;
+                x2 = sgl_min(bound.x2 - last, clip.x2);
+                for (; x <= x2; x++, buf++) {
+                    *buf = (mix == SGL_ALPHA_MAX ? color : sgl_color_mixer(color, *buf, mix));
+                }
+                x--;
+                buf--;
+                continue;
+            }
+
+            alpha_x = (alpha_y * shadow_far_scale(profile, ux, bound.x2 - bound.x1 - ux, last)) >> 8;
+            mix = (row[ux] * alpha_x + SGL_ALPHA_MAX) >> 8;
+            *buf = sgl_color_mixer(color, *buf, mix);
+        }
+    }
+}
+
+
+/**
+ * @brief draw a horizontal line with alpha
+ * @param surf surface
+ * @param area area that you want to draw
+ * @param y y coordinate
+ * @param x1 x start coordinate
+ * @param x2 x end coordinate
+ * @param width line width
+ * @param color line color
+ * @param alpha alpha of color
+ * @return none
+ */
+void sgl_draw_fill_hline(sgl_surf_t *surf, sgl_area_t *area, int16_t y, int16_t x1, int16_t x2, int16_t width, sgl_color_t color, uint8_t alpha)
+{
+    sgl_area_t rect = {
+        .x1 = sgl_min(x1, x2),
+        .y1 = y,
+        .x2 = sgl_max(x1, x2),
+        .y2 = y + width - 1,
+    };
+
+    sgl_draw_fill_rect(surf, area, &rect, color, alpha);
+}
+
+
+/**
+ * @brief draw a vertical line with alpha
+ * @param surf surface
+ * @param area area that you want to draw
+ * @param x x coordinate
+ * @param y1 y start coordinate
+ * @param y2 y end coordinate
+ * @param width line width
+ * @param color line color
+ * @param alpha alpha of color
+ * @return none
+ */
+void sgl_draw_fill_vline(sgl_surf_t *surf, sgl_area_t *area, int16_t x, int16_t y1, int16_t y2, int16_t width, sgl_color_t color, uint8_t alpha)
+{
+    sgl_area_t rect = {
+        .x1 = x,
+        .y1 = sgl_min(y1, y2),
+        .x2 = x + width - 1,
+        .y2 = sgl_max(y1, y2),
+    };
+
+    sgl_draw_fill_rect(surf, area, &rect, color, alpha);
+}
+
+
+/**
+ * @brief get the length of vector with 8 bit fraction
+ * @param sq square of the length, it should be less than 2^30
+ * @return length of vector, 8 bit fraction
+ */
+static inline int32_t line_length(uint32_t sq)
+{
+    int shift = 16;
+
+    /* keep as many fraction bits as 32 bit square root allows */
+    while (shift > 0 && (sq >> (32 - shift)) != 0) {
+        shift -= 2;
+    }
+
+    return (int32_t)sgl_sqrt(sq << shift) << (8 - shift / 2);
+}
+
+
+/**
+ * @brief draw an anti-aliased line with width
+ * @param surf surface
+ * @param area area that you want to draw
+ * @param desc line description
+ * @return none
+ * @note the line goes through the centers of start and end pixel, the width is centered
+ *       on the line, and both ends are cut flat at half pixel beyond the end points.
+ *       the coverage of a pixel is got from its distance to the line and to the ends, which
+ *       are stepped in 16.16 fixed point, and only the exact span that the line covers in
+ *       each row of the surface is visited.
+ */
+void sgl_draw_line(sgl_surf_t *surf, sgl_area_t *area, sgl_draw_line_t *desc)
+{
+    int32_t x0 = desc->start.x, y0 = desc->start.y;
+    int32_t dx = desc->end.x - x0, dy = desc->end.y - y0;
+    int32_t len, tx, ty, half, x1, x2, cd, ct;
+    int64_t sq = (int64_t)dx * dx + (int64_t)dy * dy;
+    sgl_color_t *buf;
+    sgl_area_t bound, clip;
+    uint8_t alpha;
+
+    if (desc->width <= 0 || desc->alpha == SGL_ALPHA_MIN) {
+        return;
+    }
+
+    /* the odd width straight line covers whole pixels, so fill it directly */
+    if ((desc->width & 1) && (dx == 0 || dy == 0)) {
+        if (dy == 0) {
+            sgl_draw_fill_hline(surf, area, y0 - desc->width / 2, x0, desc->end.x, desc->width, desc->color, desc->alpha);
+        }
+        else {
+            sgl_draw_fill_vline(surf, area, x0 - desc->width / 2, y0, desc->end.y, desc->width, desc->color, desc->alpha);
+        }
+        return;
+    }
+
+    if (sq >= (1 << 30)) {
+        SGL_LOG_WARN("sgl_draw_line: line is too long");
+        return;
+    }
+
+    /* unit direction of line in 16.16 fixed point, a point is horizontal */
+    len = line_length((uint32_t)sq);
+    tx = len ? (int32_t)((int64_t)dx * 0x1000000 / len) : 0x10000;
+    ty = len ? (int32_t)((int64_t)dy * 0x1000000 / len) : 0;
+    len <<= 8;
+    half = (desc->width << 15) + 0x8000;
+
+    bound.x1 = sgl_min(x0, desc->end.x) - desc->width / 2 - 1;
+    bound.y1 = sgl_min(y0, desc->end.y) - desc->width / 2 - 1;
+    bound.x2 = sgl_max(x0, desc->end.x) + desc->width / 2 + 1;
+    bound.y2 = sgl_max(y0, desc->end.y) + desc->width / 2 + 1;
+
+    if (!sgl_surf_clip(surf, &bound, &clip)) {
+        return;
+    }
+
+    if (!sgl_area_selfclip(&clip, area)) {
+        return;
+    }
+
+    for (int y = clip.y1; y <= clip.y2; y++) {
+        /* distance to line d = x * ty - y * tx, position along line t = x * tx + y * ty */
+        int64_t d_row = (int64_t)(clip.x1 - x0) * ty - (int64_t)(y - y0) * tx;
+        int64_t t_row = (int64_t)(clip.x1 - x0) * tx + (int64_t)(y - y0) * ty;
+
+        /* the exact span of this row that has coverage: -half < d < half, -1 < t < len + 1 */
+        x1 = 0;
+        x2 = clip.x2 - clip.x1;
+        fixed_span(d_row + half, ty, (int64_t)half * 2, &x1, &x2);
+        fixed_span(t_row + 0x10000, tx, (int64_t)len + 0x20000, &x1, &x2);
+        if (x1 > x2) {
+            continue;
+        }
+
+        buf = sgl_surf_get_buf(surf, clip.x1 + x1 - surf->x1, y - surf->y1);
+        /* in the span, the distance and position are bounded by the line and fit in 32 bit */
+        int32_t d = (int32_t)(d_row + (int64_t)x1 * ty);
+        int32_t t = (int32_t)(t_row + (int64_t)x1 * tx);
+
+        for (int32_t x = x1; x <= x2; x++, buf++, d += ty, t += tx) {
+            cd = sgl_min(half - sgl_abs(d), 0x10000);
+            ct = sgl_min(sgl_min(t + 0x10000, len + 0x10000 - t), 0x10000);
+            if (cd <= 0 || ct <= 0) {
+                continue;
+            }
+
+            /* coverage is in [0, 256], scale alpha without losing the full value */
+            alpha = (((cd >> 8) * (ct >> 8) >> 8) * desc->alpha) >> 8;
+            *buf = (alpha == SGL_ALPHA_MAX ? desc->color : sgl_color_mixer(desc->color, *buf, alpha));
+        }
+    }
+}
+
+
+/**
+ * @brief rounded cap of arc, it is a dot at the middle of ring
+ */
+typedef struct {
+    int16_t cx;
+    int16_t cy;
+    int16_t r;
+    uint32_t r2;
+    uint32_t rmax;
+} sgl_arc_dot_t;
+
+
+/**
+ * @brief arc drawing context, it is set up once and used by every row
+ */
+typedef struct {
+    sgl_draw_arc_t *desc;
+    int32_t in_r2;
+    int32_t in_r2_max;
+    int32_t out_r2;
+    int32_t out_r2_max;
+    int32_t in_rate;
+    int32_t out_rate;
+    int32_t dot_rate;
+    int32_t sx, sy, ex, ey;
+    uint8_t flag;
+    sgl_arc_dot_t dot[2];
+} sgl_arc_ctx_t;
+
+
+/**
+ * @brief set up the rounded cap at the direction of angle
+ * @param desc arc description
+ * @param dot [out] rounded cap
+ * @param sin sine of angle, Q15
+ * @param cos negative cosine of angle, Q15
+ * @return none
+ */
+static void arc_dot_init(sgl_draw_arc_t *desc, sgl_arc_dot_t *dot, int32_t sin, int32_t cos)
+{
+    int32_t len = (desc->radius_out + desc->radius_in) / 2;
+    int32_t r = (desc->radius_out - desc->radius_in) / 2;
+
+    dot->cx = desc->cx - (sin * len + (sin < 0 ? -16384 : 16384)) / 32768;
+    dot->cy = desc->cy - (cos * len + (cos < 0 ? -16384 : 16384)) / 32768;
+    dot->r = r > 0 ? r + 1 : 0;
+    dot->r2 = sgl_pow2(r);
+    dot->rmax = sgl_pow2(r + 1);
+}
+
+
+/**
+ * @brief get the coverage of rounded caps at a pixel
+ * @param ctx arc context
+ * @param x x coordinate of pixel
+ * @param y y coordinate of pixel
+ * @return coverage of rounded caps
+ */
+static inline uint8_t arc_get_dot(sgl_arc_ctx_t *ctx, int32_t x, int32_t y)
+{
+    uint8_t alpha, max = SGL_ALPHA_MIN;
+    uint32_t r2;
+
+    for (int k = 0; k < 2; k++) {
+        sgl_arc_dot_t *p = &ctx->dot[k];
+        int32_t dx = sgl_abs(x - p->cx), dy = sgl_abs(y - p->cy);
+
+        if (dx >= p->r || dy >= p->r) {
+            continue;
+        }
+
+        r2 = sgl_pow2(dx) + sgl_pow2(dy);
+        if (r2 >= p->rmax) {
+            alpha = SGL_ALPHA_MIN;
+        }
+        else if (r2 > p->r2) {
+            alpha = (p->rmax - r2) * ctx->dot_rate >> 8;
+        }
+        else {
+            alpha = SGL_ALPHA_MAX;
+        }
+        max = sgl_max(max, alpha);
+    }
+
+    return max;
+}
+
+
+/**
+ * @brief check whether a point is in the angle range of arc
+ * @param ctx arc context
+ * @param dx x offset from center
+ * @param dy y offset from center
+ * @return true if in range, otherwise false
+ */
+static inline bool arc_in_range(sgl_arc_ctx_t *ctx, int32_t dx, int32_t dy)
+{
+    int32_t ds, de;
+
+    if (ctx->flag == 0xff) {
+        return true;
+    }
+
+    ds = dx * ctx->sy - dy * ctx->sx;
+    de = dy * ctx->ex - dx * ctx->ey;
+    return ctx->flag > 0 ? (ds > 0 || de > 0) : (ds >= 0 && de >= 0);
+}
+
+
+/**
+ * @brief draw a pixel of arc that is on the edge of ring, the angle boundary or a rounded cap
+ * @param ctx arc context
+ * @param buf pixel of surface
+ * @param x x coordinate of pixel
+ * @param y y coordinate of pixel
+ * @return none
+ */
+static void arc_draw_pixel(sgl_arc_ctx_t *ctx, sgl_color_t *buf, int32_t x, int32_t y)
+{
+    sgl_draw_arc_t *desc = ctx->desc;
+    int32_t dx = x - desc->cx, dy = y - desc->cy, d;
+    int32_t r2 = sgl_pow2(dx) + sgl_pow2(dy);
+    sgl_color_t color = desc->color;
+    uint8_t edge_alpha;
+
+    if (r2 >= ctx->out_r2_max || r2 < ctx->in_r2_max) {
+        return;
+    }
+
+    if (r2 < ctx->in_r2) {
+        edge_alpha = (r2 - ctx->in_r2_max) * ctx->in_rate >> 8;
+    }
+    else if (r2 > ctx->out_r2) {
+        edge_alpha = (ctx->out_r2_max - r2) * ctx->out_rate >> 8;
+    }
+    else {
+        edge_alpha = SGL_ALPHA_MAX;
+    }
+
+    if (!arc_in_range(ctx, dx, dy)) {
+        int32_t ds = dx * ctx->sy - dy * ctx->sx;
+        int32_t de = dy * ctx->ex - dx * ctx->ey;
+        int32_t sd = sgl_xy_has_component(dx, dy, ctx->sx, ctx->sy) ? sgl_abs(ds) : 256;
+        int32_t ed = sgl_xy_has_component(dx, dy, ctx->ex, ctx->ey) ? sgl_abs(de) : 256;
+
+        switch (desc->mode) {
+        case SGL_ARC_MODE_NORMAL:
+            d = sgl_min(sd, ed);
+            color = (d < SGL_ALPHA_MAX) ? sgl_color_mixer(desc->color, *buf, sgl_min(SGL_ALPHA_MAX - d, edge_alpha)) : *buf;
+            break;
+
+        case SGL_ARC_MODE_RING:
+            d = sgl_min(sd, ed);
+            color = (d < SGL_ALPHA_MAX) ? sgl_color_mixer(desc->color, desc->bg_color, sgl_min(SGL_ALPHA_MAX - d, edge_alpha)) : desc->bg_color;
+            break;
+
+        case SGL_ARC_MODE_NORMAL_SMOOTH:
+            d = arc_get_dot(ctx, x, y);
+            color = (d < SGL_ALPHA_MAX) ? sgl_color_mixer(desc->color, *buf, d) : desc->color;
+            break;
+
+        case SGL_ARC_MODE_RING_SMOOTH:
+            d = arc_get_dot(ctx, x, y);
+            color = (d < SGL_ALPHA_MAX) ? sgl_color_mixer(desc->color, desc->bg_color, d) : desc->color;
+            break;
+
+        default: break;
+        }
+    }
+
+    color = sgl_color_mixer(color, *buf, edge_alpha);
+    *buf = (desc->alpha == SGL_ALPHA_MAX ? color : sgl_color_mixer(color, *buf, desc->alpha));
+}
+
+
+/**
+ * @brief fill a span of arc that is fully covered by ring and has no angle boundary
+ * @param ctx arc context
+ * @param buf first pixel of span in surface
+ * @param x1 x start coordinate of span
+ * @param x2 x end coordinate of span
+ * @param y y coordinate of span
+ * @return none
+ * @note the span is either all in angle range or all out of it, so check the first pixel only
+ */
+static void arc_fill_span(sgl_arc_ctx_t *ctx, sgl_color_t *buf, int32_t x1, int32_t x2, int32_t y)
+{
+    sgl_draw_arc_t *desc = ctx->desc;
+    sgl_color_t color = desc->color;
+
+    if (!arc_in_range(ctx, x1 - desc->cx, y - desc->cy)) {
+        if (desc->mode == SGL_ARC_MODE_NORMAL || desc->mode == SGL_ARC_MODE_NORMAL_SMOOTH) {
+            return;
+        }
+        color = desc->bg_color;
+    }
+
+    for (int32_t x = x1; x <= x2; x++, buf++) {
+        *buf = (desc->alpha == SGL_ALPHA_MAX ? color : sgl_color_mixer(color, *buf, desc->alpha));
+    }
+}
+
+
+/**
+ * @brief get the range of dx that |dx * vy - dy * vx| < 256 in a row, it is the
+ *        anti-aliasing band of an angle boundary
+ * @param dy y offset of row from center
+ * @param vx x of boundary direction, 8 bit fraction
+ * @param vy y of boundary direction, 8 bit fraction
+ * @param x1 [out] start of range, it may be one pixel wider
+ * @param x2 [out] end of range, it may be one pixel wider
+ * @return true if range is not empty
+ */
+static inline bool arc_boundary_span(int32_t dy, int32_t vx, int32_t vy, int32_t *x1, int32_t *x2)
+{
+    int32_t c = dy * vx;
+
+    if (vy == 0) {
+        *x1 = INT16_MIN;
+        *x2 = INT16_MAX;
+        return sgl_abs(c) < 256;
+    }
+
+    if (vy > 0) {
+        *x1 = (int32_t)fixed_floor_div(c - 256, vy);
+        *x2 = (int32_t)fixed_floor_div(c + 256, vy) + 1;
+    }
+    else {
+        *x1 = (int32_t)fixed_floor_div(c + 256, vy);
+        *x2 = (int32_t)fixed_floor_div(c - 256, vy) + 1;
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief draw an arc with alpha
+ * @param surf pointer to surface
+ * @param area pointer to area
+ * @param desc pointer to arc description
+ * @return none
+ * @note the angle 0 points down and increases clockwise. for every row, the ring is split
+ *       into spans by its anti-aliased edges, the bands of angle boundaries and the rounded
+ *       caps, which are computed analytically. only the pixels in these spans are blended
+ *       one by one, and other spans are filled in bulk.
+ */
+void sgl_draw_fill_arc(sgl_surf_t *surf, sgl_area_t *area, sgl_draw_arc_t *desc)
+{
+    sgl_arc_ctx_t ctx = { .desc = desc, .flag = 0xff };
+    sgl_area_t clip, rect = {
+        .x1 = desc->cx - desc->radius_out,
+        .y1 = desc->cy - desc->radius_out,
+        .x2 = desc->cx + desc->radius_out,
+        .y2 = desc->cy + desc->radius_out,
+    };
+    struct { int32_t x1, x2; } span[8], tmp;
+    int32_t dy, xo, xf, xi, xh, lo, hi, x, n;
+    sgl_color_t *buf;
+
+    if (!sgl_surf_clip(surf, &rect, &clip)) {
+        return;
+    }
+
+    if (!sgl_area_selfclip(&clip, area)) {
+        return;
+    }
+
+    ctx.out_r2 = sgl_pow2(desc->radius_out);
+    ctx.out_r2_max = sgl_pow2(desc->radius_out + 1);
+    ctx.out_rate = 0xff00 / (ctx.out_r2_max - ctx.out_r2);
+
+    /* no hole and no inner edge if inner radius is zero */
+    if (desc->radius_in > 0) {
+        ctx.in_r2 = sgl_pow2(desc->radius_in);
+        ctx.in_r2_max = sgl_pow2(desc->radius_in - 1);
+        ctx.in_rate = 0xff00 / (ctx.in_r2 - ctx.in_r2_max);
+    }
+
+    if (desc->start_angle != 0 || desc->end_angle != 360) {
+        ctx.flag = (desc->end_angle - desc->start_angle > 180) ? 1 : 0;
+        ctx.sx = sgl_sin(desc->start_angle);
+        ctx.sy = -sgl_cos(desc->start_angle);
+        ctx.ex = sgl_sin(desc->end_angle);
+        ctx.ey = -sgl_cos(desc->end_angle);
+
+        if (desc->mode == SGL_ARC_MODE_NORMAL_SMOOTH || desc->mode == SGL_ARC_MODE_RING_SMOOTH) {
+            arc_dot_init(desc, &ctx.dot[0], ctx.sx, ctx.sy);
+            arc_dot_init(desc, &ctx.dot[1], ctx.ex, ctx.ey);
+            ctx.dot_rate = 0xff00 / (ctx.dot[0].rmax - ctx.dot[0].r2);
+        }
+
+        ctx.sx >>= 7;
+        ctx.sy >>= 7;
+        ctx.ex >>= 7;
+        ctx.ey >>= 7;
+    }
+
+    for (int y = clip.y1; y <= clip.y2; y++) {
+        dy = sgl_pow2(y - desc->cy);
+        if (dy >= ctx.out_r2_max) {
+            continue;
+        }
+
+        /* the half widths of row: outside of ring, full coverage, inner edge and hole */
+        xo = sgl_sqrt(ctx.out_r2_max - dy - 1);
+        xf = ctx.out_r2 >= dy ? sgl_sqrt(ctx.out_r2 - dy) : -1;
+        xi = ctx.in_r2 > dy ? sgl_sqrt(ctx.in_r2 - dy - 1) : -1;
+        xh = ctx.in_r2_max > dy ? sgl_sqrt(ctx.in_r2_max - dy - 1) : -1;
+
+        lo = sgl_max(clip.x1, desc->cx - xo);
+        hi = sgl_min(clip.x2, desc->cx + xo);
+        if (lo > hi) {
+            continue;
+        }
+
+        /* the spans that the pixels are blended one by one */
+        n = 0;
+        span[n].x1 = desc->cx - xo; span[n++].x2 = desc->cx - xf - 1;
+        span[n].x1 = desc->cx + xf + 1; span[n++].x2 = desc->cx + xo;
+        span[n].x1 = desc->cx - xi; span[n++].x2 = desc->cx - xh - 1;
+        span[n].x1 = desc->cx + xh + 1; span[n++].x2 = desc->cx + xi;
+
+        if (ctx.flag != 0xff) {
+            if (arc_boundary_span(y - desc->cy, ctx.sx, ctx.sy, &span[n].x1, &span[n].x2)) {
+                span[n].x1 += desc->cx;
+                span[n++].x2 += desc->cx;
+            }
+            if (arc_boundary_span(y - desc->cy, ctx.ex, ctx.ey, &span[n].x1, &span[n].x2)) {
+                span[n].x1 += desc->cx;
+                span[n++].x2 += desc->cx;
+            }
+
+            for (int k = 0; k < 2; k++) {
+                if (ctx.dot[k].r > 0 && sgl_abs(y - ctx.dot[k].cy) < ctx.dot[k].r) {
+                    span[n].x1 = ctx.dot[k].cx - ctx.dot[k].r + 1;
+                    span[n++].x2 = ctx.dot[k].cx + ctx.dot[k].r - 1;
+                }
+            }
+        }
+
+        /* sort spans by start, there are a few spans only */
+        for (int i = 1; i < n; i++) {
+            tmp = span[i];
+            int j = i - 1;
+            for (; j >= 0 && span[j].x1 > tmp.x1; j--) {
+                span[j + 1] = span[j];
+            }
+            span[j + 1] = tmp;
+        }
+
+        buf = sgl_surf_get_buf(surf, lo - surf->x1, y - surf->y1);
+        x = lo;
+
+        for (int i = 0; i <= n && x <= hi; i++) {
+            int32_t s1 = (i < n) ? sgl_max(span[i].x1, x) : hi + 1;
+            int32_t s2 = (i < n) ? sgl_min(span[i].x2, hi) : hi;
+
+            /* the gap before span is fully covered, skip the hole in it */
+            if (x < s1) {
+                int32_t g2 = sgl_min(s1 - 1, hi);
+                if (xh < 0) {
+                    arc_fill_span(&ctx, buf, x, g2, y);
+                }
+                else {
+                    if (x < desc->cx - xh) {
+                        arc_fill_span(&ctx, buf, x, sgl_min(g2, desc->cx - xh - 1), y);
+                    }
+                    if (g2 > desc->cx + xh) {
+                        int32_t g1 = sgl_max(x, desc->cx + xh + 1);
+                        arc_fill_span(&ctx, buf + (g1 - x), g1, g2, y);
+                    }
+                }
+                buf += g2 - x + 1;
+                x = g2 + 1;
+            }
+
+            for (; x <= s2; x++, buf++) {
+                if (x == desc->cx - xh && xh >= 0) {
+                    buf += xh * 2;
+                    x += xh * 2;
+                    continue;
+                }
+                arc_draw_pixel(&ctx, buf, x, y);
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief Alpha blending table for 4 bpp and 2 bpp
+ */
+static const uint8_t opa4_table[16] = {0,  17, 34,  51, 68, 85, 102, 119, 136, 153, 170, 187, 204, 221, 238, 255 };
+static const uint8_t opa2_table[4]  = {0, 85, 170, 255};
+
+#if (CONFIG_SGL_FONT_COMPRESSED)
+/**
+ * @brief RLE state, refrence LVGL
+ */
+typedef enum {
+    RLE_STATE_SINGLE = 0,
+    RLE_STATE_REPEATED,
+    RLE_STATE_COUNTER,
+} sgl_font_rle_state_t;
+
+/**
+ * @brief RLE decompress information structure, it is on the stack of the caller,
+ *        so that the decoder is re-entrant
+ */
+typedef struct {
+    const uint8_t * in;
+    uint32_t acc;
+    uint8_t acc_bits;
+    uint8_t bpp;
+    uint8_t prev_v;
+    uint8_t count;
+    uint8_t state;
+    uint8_t started;
+} sgl_font_rle_t;
+
+/**
+ * @brief Number of leading one bits of a byte
+ */
+static const uint8_t rle_lead_ones[256] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 7, 8,
+};
+
+/**
+ * @brief Make sure there are enough bits in the accumulator, the bits are loaded byte by byte
+ * @param rle the RLE decompress information
+ * @param len the bit length that is needed
+ * @return none
+ */
+static inline void rle_fill(sgl_font_rle_t *rle, uint8_t len)
+{
+    while (rle->acc_bits < len) {
+        rle->acc = (rle->acc << 8) | *rle->in++;
+        rle->acc_bits += 8;
+    }
+}
+
+/**
+ * @brief Read bits from the accumulator
+ * @param rle the RLE decompress information
+ * @param len the bit length
+ * @return the bits
+ */
+static inline uint8_t rle_read(sgl_font_rle_t *rle, uint8_t len)
+{
+    rle_fill(rle, len);
+    rle->acc_bits -= len;
+    return (rle->acc >> rle->acc_bits) & ((1u << len) - 1);
+}
+
+/**
+ * @brief Read a new pixel value and go back to single state
+ * @param rle the RLE decompress information
+ * @return the pixel value
+ */
+static inline uint8_t rle_read_single(sgl_font_rle_t *rle)
+{
+    rle->prev_v = rle_read(rle, rle->bpp);
+    rle->state = RLE_STATE_SINGLE;
+    return rle->prev_v;
+}
+
+/**
+ * @brief Emit a run of the same pixel value
+ * @param out the decompressed data, NULL means skip the pixels
+ * @param v the pixel value
+ * @param n the number of pixels
+ * @return the decompressed data after the run
+ */
+static inline uint8_t* rle_emit(uint8_t *out, uint8_t v, uint32_t n)
+{
+    if (out != NULL) {
+        memset(out, v, n);
+        out += n;
+    }
+    return out;
+}
+
+/**
+ * @brief Decompress pixels of RLE data, the runs are emitted or skipped without decoding pixel by pixel
+ * @param rle the RLE decompress information
+ * @param out the decompressed data, NULL means skip the pixels
+ * @param w the number of pixels
+ * @return none
+ */
+static void rle_decompress(sgl_font_rle_t *rle, uint8_t *out, uint32_t w)
+{
+    uint32_t n, bits, ones;
+    uint8_t v;
+
+    while (w > 0) {
+        if (rle->state == RLE_STATE_SINGLE) {
+            v = rle_read(rle, rle->bpp);
+            if (rle->started && rle->prev_v == v) {
+                rle->count = 0;
+                rle->state = RLE_STATE_REPEATED;
+            }
+            rle->started = 1;
+            rle->prev_v = v;
+            out = rle_emit(out, v, 1);
+            w --;
+        }
+        else if (rle->state == RLE_STATE_REPEATED) {
+            /* every 1 bit repeats the previous pixel, count them by byte */
+            n = sgl_min(sgl_min(w, 11u - rle->count), 8u);
+            rle_fill(rle, n);
+            bits = ((rle->acc >> (rle->acc_bits - n)) << (8 - n)) & 0xFF;
+            ones = sgl_min((uint32_t)rle_lead_ones[bits], n);
+
+            /* the 11th repeat is followed by a counter, handle it below */
+            if (rle->count + ones == 11) {
+                ones --;
+            }
+
+            rle->acc_bits -= ones;
+            rle->count += ones;
+            out = rle_emit(out, rle->prev_v, ones);
+            w -= ones;
+
+            if (w == 0 || ones == n) {
+                continue;
+            }
+
+            rle->count ++;
+            if (rle_read(rle, 1) == 1) {
+                rle->count = rle_read(rle, 6);
+                if (rle->count != 0) {
+                    rle->state = RLE_STATE_COUNTER;
+                    v = rle->prev_v;
+                }
+                else {
+                    v = rle_read_single(rle);
+                }
+            }
+            else {
+                v = rle_read_single(rle);
+            }
+            out = rle_emit(out, v, 1);
+            w --;
+        }
+        else {
+            /* the last pixel of counter is replaced by a new pixel value */
+            n = sgl_min(w, (uint32_t)rle->count - 1);
+            rle->count -= n;
+            out = rle_emit(out, rle->prev_v, n);
+            w -= n;
+
+            if (w > 0) {
+                rle->count --;
+                out = rle_emit(out, rle_read_single(rle), 1);
+                w --;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Initialize the RLE decompression state
+ * @param rle the RLE decompress information
+ * @param in Pointer to the input data
+ * @param bpp Bits per pixel of the input data
+ * @return none
+ */
+static inline void rle_init(sgl_font_rle_t *rle, const uint8_t * in, uint8_t bpp)
+{
+    rle->in = in;
+    rle->acc = 0;
+    rle->acc_bits = 0;
+    rle->bpp = bpp;
+    rle->state = RLE_STATE_SINGLE;
+    rle->prev_v = 0;
+    rle->count = 0;
+    rle->started = 0;
+}
+
+/**
+ * @brief Seek the RLE decompression state to the start of a glyph row
+ * @param rle the RLE decompress information
+ * @param in Pointer to the input data
+ * @param seek Pointer to the row seek entry
+ * @return none
+ */
+static inline void rle_seek(sgl_font_rle_t *rle, const uint8_t * in, const sgl_font_rle_seek_t *seek)
+{
+    rle->in = in + (seek->rdp >> 3);
+    rle->acc = 0;
+    rle->acc_bits = 0;
+    rle->state = seek->state;
+    rle->prev_v = seek->prev_v;
+    rle->count = seek->count;
+    rle->started = (seek->rdp != 0);
+
+    if (seek->rdp & 0x7) {
+        rle_fill(rle, 8);
+        rle->acc_bits -= (seek->rdp & 0x7);
+    }
+}
+#endif // (!CONFIG_SGL_FONT_COMPRESSED)
+
+
+/**
+ * @brief Draw a character on the surface with alpha blending
+ * @param surf Pointer to the surface where the character will be drawn
+ * @param area Pointer to the area where the character will be drawn
  * @param x X coordinate where the character will be drawn
  * @param y Y coordinate where the character will be drawn
  * @param ch_index Index of the character in the font table
@@ -649,26 +2745,47 @@ void sgl_draw_character(sgl_surf_t *surf, sgl_area_t *area, int16_t x, int16_t y
 #if (CONFIG_SGL_FONT_COMPRESSED)
     }  /* support compressed font */
     else {
-        uint8_t line_buf[128] = {0};
-        font_rle_init(dot, font->bpp);
-
-        for (int y = text_rect.y1; y < clip.y1; y++) {
-            decompress_line(NULL, font_w);
+        uint8_t line_buf[64];
+        uint32_t skip_y = clip.y1 - text_rect.y1;
+        uint32_t skip_x = clip.x1 - text_rect.x1;
+        uint32_t tail_x = text_rect.x2 - clip.x2;
+        uint32_t n;
+        sgl_font_rle_t rle;
+
+        rle_init(&rle, dot, font->bpp);
+
+        /* seek to the nearest row above the clip area, the step 0 means no seek entries */
+        if (font->rle_seek != NULL && font->rle_seek_step != 0 && skip_y >= font->rle_seek_step) {
+            n = skip_y / font->rle_seek_step;
+            rle_seek(&rle, dot, &font->rle_seek[font->rle_seek_offset[ch_index] + n - 1]);
+            skip_y -= n * font->rle_seek_step;
         }
 
+        rle_decompress(&rle, NULL, skip_y * font_w);
+
         for (int y = clip.y1; y <= clip.y2; y++) {
             blend = buf;
-            decompress_line(line_buf, font_w);
+            rle_decompress(&rle, NULL, skip_x);
 
-            for (int x = clip.x1; x <= clip.x2; x++) {
-                if (font->bpp == 4) {
-                    color_mix = sgl_color_mixer(color, *blend, opa4_table[line_buf[x - text_rect.x1]]);
-                }
-                else if (font->bpp == 2) {
-                    color_mix = sgl_color_mixer(color, *blend, opa2_table[line_buf[x - text_rect.x1]]);
+            for (int x = clip.x1; x <= clip.x2; x += n) {
+                n = sgl_min((uint32_t)(clip.x2 - x + 1), sizeof(line_buf));
+                rle_decompress(&rle, line_buf, n);
+
+                for (uint32_t i = 0; i < n; i++) {
+                    if (font->bpp == 4) {
+                        color_mix = sgl_color_mixer(color, *blend, opa4_table[line_buf[i]]);
+                    }
+                    else if (font->bpp == 2) {
+                        color_mix = sgl_color_mixer(color, *blend, opa2_table[line_buf[i]]);
+                    }
+                    *blend = sgl_color_mixer(color_mix, *blend, alpha);
+                    blend++;
                 }
-                *blend = sgl_color_mixer(color_mix, *blend, alpha);
-                blend++;
+            }
+
+            /* the rows below the clip area are not needed */
+            if (y < clip.y2) {
+                rle_decompress(&rle, NULL, tail_x);
             }
             buf += surf->w;
         }
@@ -691,14 +2808,16 @@ void sgl_draw_character(sgl_surf_t *surf, sgl_area_t *area, int16_t x, int16_t y
  */
 void sgl_draw_string(sgl_surf_t *surf, sgl_area_t *area, int16_t x, int16_t y, const char *str, sgl_color_t color, uint8_t alpha, const sgl_font_t *font)
 {
-    uint32_t ch_index;
-    uint32_t unicode = 0;
-
-    while (*str) {
-        str += sgl_utf8_to_unicode(str, &unicode);
-        ch_index = sgl_search_unicode_ch_index(font, unicode);
-        sgl_draw_character(surf, area, x, y, ch_index, color, alpha, font);
-        x += (font->table[ch_index].adv_w >> 4);
+    sgl_glyph_code_t glyph[SGL_GLYPH_CHUNK_SIZE];
+    uint32_t num = 0;
+
+    while ((num = sgl_font_decode_string(&str, font, glyph, SGL_GLYPH_CHUNK_SIZE)) > 0) {
+        for (uint32_t i = 0; i < num; i++) {
+            if (glyph[i].index != SGL_GLYPH_LINE_BREAK) {
+                sgl_draw_character(surf, area, x, y, glyph[i].index, color, alpha, font);
+                x += glyph[i].adv_w;
+            }
+        }
     }
 }
 
@@ -718,29 +2837,49 @@ void sgl_draw_string(sgl_surf_t *surf, sgl_area_t *area, int16_t x, int16_t y, c
  */
 void sgl_draw_string_mult_line(sgl_surf_t *surf, sgl_area_t *area, int16_t x, int16_t y, const char *str, sgl_color_t color, uint8_t alpha, const sgl_font_t *font, uint8_t line_margin)
 {
-    int16_t ch_index, ch_width;
+    sgl_glyph_code_t glyph[SGL_GLYPH_CHUNK_SIZE];
+    uint32_t num = 0;
     int16_t x_off = x;
-    uint32_t unicode = 0;
-
-    while (*str) {
-        if (*str == '\n') {
-            x_off = x;
-            y += (font->font_height + line_margin);
-            str ++;
-            continue;
-        }
 
-        str += sgl_utf8_to_unicode(str, &unicode);
-        ch_index = sgl_search_unicode_ch_index(font, unicode);
+    while ((num = sgl_font_decode_string(&str, font, glyph, SGL_GLYPH_CHUNK_SIZE)) > 0) {
+        for (uint32_t i = 0; i < num; i++) {
+            if (glyph[i].index == SGL_GLYPH_LINE_BREAK) {
+                x_off = x;
+                y += (font->font_height + line_margin);
+                continue;
+            }
 
-        ch_width = (font->table[ch_index].adv_w >> 4);
+            if ((x_off + glyph[i].adv_w) > area->x2) {
+                x_off = x;
+                y += (font->font_height + line_margin);
+            }
 
-        if ((x_off + ch_width) > area->x2) {
-            x_off = x;
-            y += (font->font_height + line_margin);
+            sgl_draw_character(surf, area, x_off, y, glyph[i].index, color, alpha, font);
+            x_off += glyph[i].adv_w;
         }
+    }
+}
+
+
+/**
+ * @brief Draw a measured text layout on the surface with alpha blending
+ * @param surf Pointer to the surface where the text will be drawn
+ * @param area Pointer to the area where the text will be drawn
+ * @param x X coordinate of the top-left corner of the text
+ * @param y Y coordinate of the top-left corner of the text
+ * @param layout Pointer to the text layout that built by sgl_text_layout_build()
+ * @param color Foreground color of the text
+ * @param alpha Alpha value for blending
+ * @param font Pointer to the font structure that the layout is built with
+ * @param line_space Line space that the layout is built with
+ * @return none
+ */
+void sgl_draw_text_layout(sgl_surf_t *surf, sgl_area_t *area, int16_t x, int16_t y, sgl_text_layout_t *layout, sgl_color_t color, uint8_t alpha, const sgl_font_t *font, uint8_t line_space)
+{
+    sgl_text_glyph_t *glyph = layout->glyph;
+    int16_t line_h = font->font_height + line_space;
 
-        sgl_draw_character(surf, area, x_off, y, ch_index, color, alpha, font);
-        x_off += ch_width;
+    for (uint16_t i = 0; i < layout->glyph_num; i++, glyph++) {
+        sgl_draw_character(surf, area, x + glyph->x, y + glyph->line * line_h, glyph->index, color, alpha, font);
     }
 }
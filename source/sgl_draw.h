@@ -28,6 +28,29 @@ extern "C" {
 #define  SGL_ARC_MODE_NORMAL_SMOOTH                         (2)
 #define  SGL_ARC_MODE_RING_SMOOTH                           (3)
 
+/* the type of gradient, and the size of its color table */
+#define  SGL_GRADIENT_LINEAR                                (0)
+#define  SGL_GRADIENT_RADIAL                                (1)
+#define  SGL_GRADIENT_LUT_SIZE                              (256)
+
+
+/* the sample filter of transformed pixmap */
+#define  SGL_DRAW_FILTER_NEAREST                            (0)
+#define  SGL_DRAW_FILTER_BILINEAR                           (1)
+
+
+/**
+ * @brief gradient description, it is built by sgl_gradient_init()
+ * @lut: color table from start to end, in the pixel format of surface
+ * @angle: direction of linear gradient in degree, 0 is from left to right
+ * @type: type of gradient, SGL_GRADIENT_LINEAR or SGL_GRADIENT_RADIAL
+ */
+typedef struct sgl_gradient {
+    sgl_color_t             lut[SGL_GRADIENT_LUT_SIZE];
+    int16_t                 angle;
+    uint8_t                 type;
+} sgl_gradient_t;
+
 
 /**
  * @brief rect description
@@ -36,6 +59,14 @@ extern "C" {
  * @border: border of rect
  * @border_color: border color of rect
  * @pixmap: pixmap of rect
+ * @gradient: gradient of rect, it is used instead of color if not NULL, and the border is not drawn
+ * @shadow_color: color of shadow
+ * @shadow_width: blur width of shadow, 0 means no shadow
+ * @shadow_spread: size that shadow grows from rect
+ * @shadow_alpha: alpha of shadow
+ * @shadow_ofs_x: x offset of shadow
+ * @shadow_ofs_y: y offset of shadow
+ * @shadow_mask: blurred corner mask of shadow, it's got when shadow is set, NULL means no shadow
  */
 typedef struct sgl_draw_rect {
     sgl_color_t             color;
@@ -44,6 +75,14 @@ typedef struct sgl_draw_rect {
     uint8_t                 border;
     sgl_color_t             border_color;
     const sgl_pixmap_t      *pixmap;
+    const sgl_gradient_t    *gradient;
+    sgl_color_t             shadow_color;
+    uint8_t                 shadow_width;
+    uint8_t                 shadow_spread;
+    uint8_t                 shadow_alpha;
+    int8_t                  shadow_ofs_x;
+    int8_t                  shadow_ofs_y;
+    sgl_shadow_mask_t       *shadow_mask;
 } sgl_draw_rect_t;
 
 
@@ -114,6 +153,31 @@ typedef struct sgl_draw_arc {
 } sgl_draw_arc_t;
 
 
+/**
+ * @brief transformed pixmap description, the pixmap is zoomed and rotated around its pivot
+ * @pixmap: source pixmap, it must be a raw pixmap in internal memory
+ * @pivot_x: x position of pivot in pixmap
+ * @pivot_y: y position of pivot in pixmap
+ * @cx: x position on surface that the pivot is placed at
+ * @cy: y position on surface that the pivot is placed at
+ * @angle: rotation angle in degree, clockwise
+ * @zoom: zoom factor, 256 means no zoom
+ * @alpha: alpha of pixmap
+ * @filter: sample filter, SGL_DRAW_FILTER_NEAREST or SGL_DRAW_FILTER_BILINEAR
+ */
+typedef struct sgl_draw_transform {
+    const sgl_pixmap_t *pixmap;
+    int16_t            pivot_x;
+    int16_t            pivot_y;
+    int16_t            cx;
+    int16_t            cy;
+    int16_t            angle;
+    uint16_t           zoom;
+    uint8_t            alpha;
+    uint8_t            filter;
+} sgl_draw_transform_t;
+
+
 /**
  * @brief icon description
  * @icon: icon pixmap
@@ -299,6 +363,91 @@ void sgl_draw_fill_round_rect_with_border(sgl_surf_t *surf, sgl_area_t *area, sg
 void sgl_draw_fill_round_rect_pixmap(sgl_surf_t *surf, sgl_area_t *area, sgl_area_t *rect, int16_t radius, const sgl_pixmap_t *pixmap, uint8_t alpha);
 
 
+/**
+ * @brief build the color table of gradient
+ * @param grad pointer to gradient
+ * @param type type of gradient, SGL_GRADIENT_LINEAR or SGL_GRADIENT_RADIAL
+ * @param angle direction of linear gradient in degree, 0 is from left to right, 90 is from top to bottom
+ * @param start_color color at start of linear gradient or at center of radial gradient
+ * @param end_color color at end of linear gradient or at the farthest corner of radial gradient
+ * @return none
+ */
+void sgl_gradient_init(sgl_gradient_t *grad, uint8_t type, int16_t angle, sgl_color_t start_color, sgl_color_t end_color);
+
+
+/**
+ * @brief fill a rect or round rect with gradient and alpha
+ * @param surf point to surface
+ * @param area area of rectangle that you want to draw
+ * @param rect point to rectangle that you want to draw
+ * @param radius radius of round, 0 means no round
+ * @param grad gradient of rectangle
+ * @param alpha alpha of rectangle
+ * @return none
+ */
+void sgl_draw_fill_rect_gradient(sgl_surf_t *surf, sgl_area_t *area, sgl_area_t *rect, int16_t radius, const sgl_gradient_t *grad, uint8_t alpha);
+
+
+/**
+ * @brief get the blurred corner mask of shadow, the mask of same radius and blur is shared
+ * @param radius radius of corner, it should be got by sgl_draw_rect_shadow_radius()
+ * @param blur half width of box blur
+ * @return pointer to mask, NULL means out of memory
+ * @note it should be called when the shadow is set, so drawing never allocates, and the mask
+ *       should be released by sgl_draw_shadow_mask_put()
+ */
+sgl_shadow_mask_t* sgl_draw_shadow_mask_get(int16_t radius, uint8_t blur);
+
+
+/**
+ * @brief release the blurred corner mask of shadow, it's freed if no shadow uses it
+ * @param mask point to mask, NULL means no mask
+ * @return none
+ */
+void sgl_draw_shadow_mask_put(sgl_shadow_mask_t *mask);
+
+
+/**
+ * @brief draw the blurred shadow of a round rectangle with alpha
+ * @param surf point to surface
+ * @param area area of shadow that you want to draw
+ * @param rect point to shape of shadow, the blur goes out of it by blur of mask
+ * @param mask blurred corner mask of shadow, it's got by sgl_draw_shadow_mask_get()
+ * @param color color of shadow
+ * @param alpha alpha of shadow
+ * @return none
+ */
+void sgl_draw_fill_shadow(sgl_surf_t *surf, sgl_area_t *area, sgl_area_t *rect, const sgl_shadow_mask_t *mask, sgl_color_t color, uint8_t alpha);
+
+
+/**
+ * @brief get the corner radius of shadow shape of rect, it's limited by the size of shape
+ * @param rect point to rectangle
+ * @param desc rectangle description
+ * @return radius of shadow shape, it's the key of shadow mask with blur
+ */
+static inline int16_t sgl_draw_rect_shadow_radius(sgl_area_t *rect, sgl_draw_rect_t *desc)
+{
+    int16_t side = sgl_min(rect->x2 - rect->x1, rect->y2 - rect->y1) + 2 * desc->shadow_spread;
+    return sgl_max(0, sgl_min(desc->radius + desc->shadow_spread, side / 2));
+}
+
+
+/**
+ * @brief get the size that shadow of rect goes out of rect
+ * @param desc rectangle description
+ * @return size out of rect, it should be the draw extension of object
+ */
+static inline int16_t sgl_draw_rect_shadow_ext(sgl_draw_rect_t *desc)
+{
+    if (desc->shadow_width == 0) {
+        return 0;
+    }
+
+    return desc->shadow_spread + desc->shadow_width / 2 + sgl_max(sgl_abs(desc->shadow_ofs_x), sgl_abs(desc->shadow_ofs_y));
+}
+
+
 /**
  * @brief fill a round rectangle with alpha
  * @param surf point to surface
@@ -310,6 +459,27 @@ void sgl_draw_fill_round_rect_pixmap(sgl_surf_t *surf, sgl_area_t *area, sgl_are
 void sgl_draw_rect(sgl_surf_t *surf, sgl_area_t *area, sgl_rect_t *rect, sgl_draw_rect_t *desc);
 
 
+/**
+ * @brief get the bounding area of transformed pixmap
+ * @param desc transformed pixmap description
+ * @param out [out] bounding area of transformed pixmap on surface
+ * @return none
+ */
+void sgl_draw_transform_get_area(sgl_draw_transform_t *desc, sgl_area_t *out);
+
+
+/**
+ * @brief draw a zoomed and rotated pixmap
+ * @param surf point to surface
+ * @param area area that you want to draw
+ * @param desc transformed pixmap description
+ * @return none
+ * @note the source position is stepped in 16.16 fixed point, and only the pixels in the
+ *       exact row span of transformed pixmap are visited
+ */
+void sgl_draw_pixmap_transform(sgl_surf_t *surf, sgl_area_t *area, sgl_draw_transform_t *desc);
+
+
 /**
  * @brief Draw a circle
  * @param surf Surface
@@ -427,6 +597,22 @@ void sgl_draw_string(sgl_surf_t *surf, sgl_area_t *area, int16_t x, int16_t y, c
 void sgl_draw_string_mult_line(sgl_surf_t *surf, sgl_area_t *area, int16_t x, int16_t y, const char *str, sgl_color_t color, uint8_t alpha, const sgl_font_t *font, uint8_t line_margin);
 
 
+/**
+ * @brief Draw a measured text layout on the surface with alpha blending
+ * @param surf Pointer to the surface where the text will be drawn
+ * @param area Pointer to the area where the text will be drawn
+ * @param x X coordinate of the top-left corner of the text
+ * @param y Y coordinate of the top-left corner of the text
+ * @param layout Pointer to the text layout that built by sgl_text_layout_build()
+ * @param color Foreground color of the text
+ * @param alpha Alpha value for blending
+ * @param font Pointer to the font structure that the layout is built with
+ * @param line_space Line space that the layout is built with
+ * @return none
+ */
+void sgl_draw_text_layout(sgl_surf_t *surf, sgl_area_t *area, int16_t x, int16_t y, sgl_text_layout_t *layout, sgl_color_t color, uint8_t alpha, const sgl_font_t *font, uint8_t line_space);
+
+
 /**
  * @brief draw a ring on surface with alpha
  * @param surf: pointer of surface
@@ -445,6 +631,7 @@ void sgl_draw_fill_ring(sgl_surf_t *surf, sgl_area_t *area, int16_t cx, int16_t
 /**
  * @brief draw a horizontal line with alpha
  * @param surf surface
+ * @param area area that you want to draw
  * @param y y coordinate
  * @param x1 x start coordinate
  * @param x2 x end coordinate
@@ -453,12 +640,13 @@ void sgl_draw_fill_ring(sgl_surf_t *surf, sgl_area_t *area, int16_t cx, int16_t
  * @param alpha alpha of color
  * @return none
  */
-void sgl_draw_fill_hline(sgl_surf_t *surf, int16_t y, int16_t x1, int16_t x2, int16_t width, sgl_color_t color, uint8_t alpha);
+void sgl_draw_fill_hline(sgl_surf_t *surf, sgl_area_t *area, int16_t y, int16_t x1, int16_t x2, int16_t width, sgl_color_t color, uint8_t alpha);
 
 
 /**
  * @brief draw a vertical line with alpha
  * @param surf surface
+ * @param area area that you want to draw
  * @param x x coordinate
  * @param y1 y start coordinate
  * @param y2 y end coordinate
@@ -467,16 +655,18 @@ void sgl_draw_fill_hline(sgl_surf_t *surf, int16_t y, int16_t x1, int16_t x2, in
  * @param alpha alpha of color
  * @return none
  */
-void sgl_draw_fill_vline(sgl_surf_t *surf, int16_t x, int16_t y1, int16_t y2, int16_t width, sgl_color_t color, uint8_t alpha);
+void sgl_draw_fill_vline(sgl_surf_t *surf, sgl_area_t *area, int16_t x, int16_t y1, int16_t y2, int16_t width, sgl_color_t color, uint8_t alpha);
 
 
 /**
- * @brief draw a line
+ * @brief draw an anti-aliased line with width
  * @param surf surface
+ * @param area area that you want to draw
  * @param desc line description
  * @return none
+ * @note the width is centered on the line that goes through the centers of start and end pixel
  */
-void sgl_draw_line(sgl_surf_t *surf, sgl_draw_line_t *desc);
+void sgl_draw_line(sgl_surf_t *surf, sgl_area_t *area, sgl_draw_line_t *desc);
 
 
 /**
@@ -485,6 +675,7 @@ void sgl_draw_line(sgl_surf_t *surf, sgl_draw_line_t *desc);
  * @param area pointer to area
  * @param desc pointer to arc description
  * @return none
+ * @note the angle 0 points down and increases clockwise
  */
 void sgl_draw_fill_arc(sgl_surf_t *surf, sgl_area_t *area, sgl_draw_arc_t *desc);
 
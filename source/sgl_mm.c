@@ -15,40 +15,808 @@
  */
 
 #include "sgl_mm.h"
+#include "tlsf.h"
 #include <stdint.h>
-#include <stdlib.h>
 #include <string.h>
 
+/**
+ * @brief  slab class, free objects are linked by their first word
+ * @free_list: first free object
+ * @monitor: statistics of class
+ */
+typedef struct sgl_slab_class {
+    void               *free_list;
+    sgl_slab_monitor_t monitor;
+} sgl_slab_class_t;
+
+
+#if (CONFIG_SGL_MM_TRACE)
+/**
+ * @brief  allocation tally of call site
+ * @file: file name of call site, NULL means the sites that are out of table
+ * @line: line number of call site
+ * @alloc_num: number of allocations
+ * @free_num: number of frees
+ * @live_size: size of memory that is still allocated
+ */
+typedef struct sgl_mm_site {
+    const char  *file;
+    int         line;
+    size_t      alloc_num;
+    size_t      free_num;
+    size_t      live_size;
+} sgl_mm_site_t;
+
+
+/* the call sites that are out of table are collected by one site */
+#define  MM_SITE_OTHER                           (CONFIG_SGL_MM_TRACE_SITE_NUM)
+/* the internal allocations, such as slab chunks and frame spills, are kept out of report */
+#define  MM_SITE_INTERNAL                        (CONFIG_SGL_MM_TRACE_SITE_NUM + 1)
+
+
+static sgl_mm_site_t mm_site[CONFIG_SGL_MM_TRACE_SITE_NUM + 2];
+#endif
+
+
+static sgl_slab_class_t slab_class[CONFIG_SGL_SLAB_CLASS_NUM];
+/**
+ * @brief  frame arena, the spilled blocks are linked by their first word
+ * @buf: start address of arena
+ * @size: size of arena
+ * @pos: used size of arena
+ * @spill_size: size of spilled blocks in this frame
+ * @spill: first spilled block
+ */
+typedef struct sgl_frame_arena {
+    uint8_t     *buf;
+    size_t      size;
+    size_t      pos;
+    size_t      spill_size;
+    void        *spill;
+} sgl_frame_arena_t;
+
+
+/**
+ * @brief  heap of memory, it's made of one or more pools
+ * @tlsf: allocator of heap, NULL means heap has no pool
+ * @monitor: statistics of heap
+ */
+typedef struct sgl_mm_heap {
+    tlsf_t            tlsf;
+    sgl_mm_monitor_t  monitor;
+} sgl_mm_heap_t;
+
+
+/**
+ * @brief  memory pool, it's used to find the heap of block
+ * @start: start address of pool
+ * @end: end address of pool
+ * @heap: index of heap that the pool belongs to
+ */
+typedef struct sgl_mm_pool {
+    uint8_t     *start;
+    uint8_t     *end;
+    uint8_t     heap;
+} sgl_mm_pool_t;
+
+
+static sgl_frame_arena_t frame_arena;
+static bool mm_steady = false;
+static size_t frame_alloc = 0, frame_free = 0;
+static sgl_mm_heap_t mm_heap[CONFIG_SGL_MM_HEAP_NUM];
+static sgl_mm_pool_t mm_pool[CONFIG_SGL_MM_POOL_NUM];
+static size_t mm_pool_num = 0;
+#if (CONFIG_SGL_MM_THREAD_NUM)
+/**
+ * @brief  lock operations of memory, they are registered by port
+ * @lock: lock the shared heaps
+ * @unlock: unlock the shared heaps
+ * @thread_id: get index of thread cache, negative means thread has no cache
+ */
+static struct {
+    void        (*lock)(void);
+    void        (*unlock)(void);
+    int         (*thread_id)(void);
+} mm_ops;
+
+
+#define  MM_LOCK()                               do { if (mm_ops.lock) mm_ops.lock(); } while (0)
+#define  MM_UNLOCK()                             do { if (mm_ops.unlock) mm_ops.unlock(); } while (0)
+
+/* the header of block keeps its cache class, so the thread cache is not used in trace mode */
+#define  MM_CACHE_ENABLE                         (!CONFIG_SGL_MM_TRACE)
+#else
+#define  MM_LOCK()                               do {} while (0)
+#define  MM_UNLOCK()                             do {} while (0)
+#define  MM_CACHE_ENABLE                         (0)
+#endif
+
+
+#if (MM_CACHE_ENABLE)
+/* the classes of thread cache are 32, 64, 128 and 256 bytes */
+#define  MM_CACHE_CLASS_NUM                      (4)
+#define  MM_CACHE_SIZE(cls)                      ((size_t)32 << (cls))
+
+
+/**
+ * @brief  free list cache of thread, it's only touched by its thread without lock
+ * @free_list: first free memory of every class, the memory is linked by its first word
+ * @count: number of free blocks of every class
+ */
+typedef struct sgl_mm_cache {
+    void        *free_list[MM_CACHE_CLASS_NUM];
+    uint16_t    count[MM_CACHE_CLASS_NUM];
+} sgl_mm_cache_t;
+
+
+static sgl_mm_cache_t mm_cache[CONFIG_SGL_MM_THREAD_NUM];
+#endif
+
+
 static sgl_mm_monitor_t mem = {
     .total_size = 0,
     .free_size = 0,
     .used_size = 0,
+    .peak_size = 0,
 };
 
+
 /**
- * @brief  initialize memory pool
+ * @brief  add free block size of pool walker
+ * @param  ptr  pointer of block
+ * @param  size  size of block
+ * @param  used  block is used or not
+ * @param  user  point to size of free blocks
+ */
+static void mm_free_walker(void *ptr, size_t size, int used, void *user)
+{
+    SGL_UNUSED(ptr);
+
+    if (!used) {
+        *(size_t*)user += size + tlsf_alloc_overhead();
+    }
+}
+
+
+/**
+ * @brief  align start address of memory pool
  * @param  mem_start  start address of memory pool
+ * @param  len  [in][out] length of memory pool
+ * @return aligned start address, NULL means the pool is too small
+ */
+static void* mm_align_pool(void *mem_start, size_t *len)
+{
+    size_t align = tlsf_align_size();
+    size_t ofs = (align - ((uintptr_t)mem_start & (align - 1))) & (align - 1);
+
+    if (*len <= ofs) {
+        return NULL;
+    }
+
+    *len -= ofs;
+    return (uint8_t*)mem_start + ofs;
+}
+
+
+/**
+ * @brief  account the memory used by allocator itself
+ * @param  heap  heap of pool
+ * @param  pool  pool that is just added
  * @param  len  length of memory pool
  */
-void sgl_mm_init(void *mem_start, size_t len)
+static void mm_account_pool(sgl_mm_heap_t *heap, pool_t pool, size_t len)
 {
-    SGL_UNUSED(mem_start);
+    size_t free_size = 0;
+
+    tlsf_walk_pool(pool, mm_free_walker, &free_size);
+    heap->monitor.total_size += len;
+    heap->monitor.used_size += len - free_size;
+    heap->monitor.peak_size = sgl_max(heap->monitor.peak_size, heap->monitor.used_size);
     mem.total_size += len;
+    mem.used_size += len - free_size;
+    mem.peak_size = sgl_max(mem.peak_size, mem.used_size);
+}
+
+
+/**
+ * @brief  initialize memory pool, the pool is added to fast heap
+ * @param  mem_start  start address of memory pool
+ * @param  len  length of memory pool
+ */
+void sgl_mm_init(void *mem_start, size_t len)
+{
+#if (MM_CACHE_ENABLE)
+    memset(mm_cache, 0, sizeof(mm_cache));
+#endif
+    memset(&mem, 0, sizeof(mem));
+    memset(mm_heap, 0, sizeof(mm_heap));
+    memset(slab_class, 0, sizeof(slab_class));
+#if (CONFIG_SGL_MM_TRACE)
+    memset(mm_site, 0, sizeof(mm_site));
+#endif
+    mm_pool_num = 0;
+    frame_alloc = frame_free = 0;
+
+    sgl_mm_add_heap_pool(SGL_MM_HEAP_FAST, mem_start, len);
 }
 
 
 /**
- * @brief  add memory pool
+ * @brief  add memory pool to fast heap
  * @param  mem_start  start address of memory pool
  * @param  len  length of memory pool
  */
 void sgl_mm_add_pool(void *mem_start, size_t len)
 {
-    SGL_UNUSED(mem_start);
-    mem.total_size += len;
+    sgl_mm_add_heap_pool(SGL_MM_HEAP_FAST, mem_start, len);
+}
+
+
+/**
+ * @brief  add memory pool to heap, it should be called after sgl_mm_init()
+ * @param  heap  heap of pool, such as SGL_MM_HEAP_FAST or SGL_MM_HEAP_BULK
+ * @param  mem_start  start address of memory pool
+ * @param  len  length of memory pool
+ * @return none
+ * @note   at most CONFIG_SGL_MM_POOL_NUM pools can be added, including the pool of sgl_mm_init()
+ */
+void sgl_mm_add_heap_pool(uint8_t heap, void *mem_start, size_t len)
+{
+    size_t size = len;
+    uint8_t *start = mm_align_pool(mem_start, &size);
+    sgl_mm_heap_t *h;
+    tlsf_t tlsf;
+    pool_t pool;
+
+    if (heap >= CONFIG_SGL_MM_HEAP_NUM || mm_pool_num >= CONFIG_SGL_MM_POOL_NUM) {
+        SGL_LOG_ERROR("sgl_mm_add_heap_pool: invalid heap or pool table is full");
+        return;
+    }
+
+    h = &mm_heap[heap];
+    if (start == NULL || (h->tlsf == NULL && size <= tlsf_size())) {
+        SGL_LOG_ERROR("sgl_mm_add_heap_pool: memory pool is too small");
+        return;
+    }
+
+    MM_LOCK();
+    if (h->tlsf == NULL) {
+        /* the control structure is put at the start of first pool, the heap is kept
+         * empty if the rest of pool is rejected, such as it's larger than 2^FL_INDEX_MAX
+         */
+        tlsf = tlsf_create(start);
+        pool = tlsf != NULL ? tlsf_add_pool(tlsf, start + tlsf_size(), size - tlsf_size()) : NULL;
+        if (pool != NULL) {
+            h->tlsf = tlsf;
+        }
+    }
+    else {
+        pool = tlsf_add_pool(h->tlsf, start, size);
+    }
+
+    if (pool == NULL) {
+        MM_UNLOCK();
+        SGL_LOG_ERROR("sgl_mm_add_heap_pool: add memory pool failed, the pool is too small or larger than 2^CONFIG_SGL_FL_INDEX_MAX");
+        return;
+    }
+
+    mm_pool[mm_pool_num].start = start;
+    mm_pool[mm_pool_num].end = start + size;
+    mm_pool[mm_pool_num].heap = heap;
+    mm_pool_num ++;
+
+    mm_account_pool(h, pool, len);
+    MM_UNLOCK();
+}
+
+
+/**
+ * @brief  get heap of block by the address
+ * @param  block  pointer of block
+ * @return heap of block
+ */
+static inline sgl_mm_heap_t* mm_heap_of(void *block)
+{
+    size_t i;
+
+    for (i = 0; i < mm_pool_num; i++) {
+        if ((uint8_t*)block >= mm_pool[i].start && (uint8_t*)block < mm_pool[i].end) {
+            break;
+        }
+    }
+
+    SGL_ASSERT(i < mm_pool_num);
+    return &mm_heap[i < mm_pool_num ? mm_pool[i].heap : SGL_MM_HEAP_FAST];
+}
+
+
+#if (CONFIG_SGL_MM_TRACE)
+/* the call site is kept in a header before memory */
+#define  MM_HEAD_SIZE                            tlsf_align_size()
+
+
+/**
+ * @brief  get tally of call site, it's added if it does not exist
+ * @param  file  file name of call site, NULL means internal allocation
+ * @param  line  line number of call site
+ * @return index of call site
+ */
+static size_t mm_site_get(const char *file, int line)
+{
+    size_t i;
+
+    if (file == NULL) {
+        return MM_SITE_INTERNAL;
+    }
+
+    for (i = 0; i < CONFIG_SGL_MM_TRACE_SITE_NUM && mm_site[i].file != NULL; i++) {
+        if (mm_site[i].line == line && (mm_site[i].file == file || strcmp(mm_site[i].file, file) == 0)) {
+            return i;
+        }
+    }
+
+    if (i < CONFIG_SGL_MM_TRACE_SITE_NUM) {
+        mm_site[i].file = file;
+        mm_site[i].line = line;
+    }
+
+    return i;
+}
+#elif (MM_CACHE_ENABLE)
+/* the cache class is kept in a header before memory */
+#define  MM_HEAD_SIZE                            tlsf_align_size()
+
+
+/**
+ * @brief  get cache class of block, the block is cached in the class that it fits best
+ * @param  heap  heap of block
+ * @param  size  size of memory without header
+ * @return class of thread cache, MM_CACHE_CLASS_NUM means the block is not cached
+ */
+static inline size_t mm_cache_class(sgl_mm_heap_t *heap, size_t size)
+{
+    size_t cls = 0;
+
+    if (heap != &mm_heap[SGL_MM_HEAP_FAST] || size < MM_CACHE_SIZE(0)) {
+        return MM_CACHE_CLASS_NUM;
+    }
+
+    while (cls < MM_CACHE_CLASS_NUM && MM_CACHE_SIZE(cls) * 2 <= size) {
+        cls ++;
+    }
+
+    return cls;
+}
+#else
+#define  MM_HEAD_SIZE                            (0)
+#endif
+
+
+/**
+ * @brief  account a block that is allocated
+ * @param  heap  heap of block
+ * @param  size  size of block
+ * @return none
+ */
+static inline void mm_account_alloc(sgl_mm_heap_t *heap, size_t size)
+{
+    size += tlsf_alloc_overhead();
+    heap->monitor.used_size += size;
+    heap->monitor.peak_size = sgl_max(heap->monitor.peak_size, heap->monitor.used_size);
+    heap->monitor.alloc_count ++;
+    mem.used_size += size;
+    mem.peak_size = sgl_max(mem.peak_size, mem.used_size);
+    mem.alloc_count ++;
+    frame_alloc ++;
+}
+
+
+/**
+ * @brief  account a block that is freed
+ * @param  heap  heap of block
+ * @param  size  size of block
+ * @return none
+ */
+static inline void mm_account_free(sgl_mm_heap_t *heap, size_t size)
+{
+    size += tlsf_alloc_overhead();
+    heap->monitor.used_size -= size;
+    heap->monitor.free_count ++;
+    mem.used_size -= size;
+    mem.free_count ++;
+    frame_free ++;
+}
+
+
+/**
+ * @brief  check allocation in steady state
+ * @param  size  request size of memory
+ * @param  file  file name of call site, NULL means unknown
+ * @param  line  line number of call site
+ * @return none
+ * @note   the allocation is always counted by steady_count of monitor, it's logged and
+ *         asserted in debug only. it should be called with lock, once per allocation
+ */
+static inline void mm_steady_check(size_t size, const char *file, int line)
+{
+    SGL_UNUSED(size);
+    SGL_UNUSED(file);
+    SGL_UNUSED(line);
+
+    if (unlikely(mm_steady)) {
+        mem.steady_count ++;
+        SGL_LOG_ERROR("allocate %d bytes in steady state at %s:%d", (int)size, file ? file : "?", line);
+        SGL_ASSERT(!mm_steady);
+    }
+}
+
+
+/**
+ * @brief  alloc block from heaps, the hinted heap is tried first, then the other heaps in order
+ * @param  size  size of block
+ * @param  hint  hinted heap
+ * @param  heap  [out] heap that the block is allocated from
+ * @return pointer of block, NULL means all heaps are full
+ */
+static void* mm_heap_alloc(size_t size, uint8_t hint, sgl_mm_heap_t **heap)
+{
+    void *block;
+
+    if (unlikely(hint >= CONFIG_SGL_MM_HEAP_NUM)) {
+        hint = SGL_MM_HEAP_FAST;
+    }
+
+    for (int i = -1; i < CONFIG_SGL_MM_HEAP_NUM; i++) {
+        *heap = &mm_heap[i < 0 ? hint : i];
+        if (i == hint || (*heap)->tlsf == NULL) {
+            continue;
+        }
+
+        block = tlsf_malloc((*heap)->tlsf, size);
+        if (block != NULL) {
+            if (i >= 0) {
+                mm_heap[hint].monitor.fallback_count ++;
+                mem.fallback_count ++;
+            }
+            return block;
+        }
+    }
+
+    return NULL;
+}
+
+
+/**
+ * @brief  memory alloc with call site
+ * @param  size   request size of memory
+ * @param  hint   hinted heap
+ * @param  file   file name of call site, NULL means unknown
+ * @param  line   line number of call site
+ * @return point to request memory address
+ */
+static void* mm_malloc(size_t size, uint8_t hint, const char *file, int line)
+{
+    SGL_ASSERT(mm_pool_num > 0);
+    sgl_mm_heap_t *heap;
+    uint8_t *block;
+
+    mm_steady_check(size, file, line);
+
+    block = mm_heap_alloc(size + MM_HEAD_SIZE, hint, &heap);
+    if (block == NULL) {
+        SGL_LOG_ERROR("sgl_malloc: out of memory");
+        return NULL;
+    }
+
+    mm_account_alloc(heap, tlsf_block_size(block));
+
+#if (CONFIG_SGL_MM_TRACE)
+    size_t site = mm_site_get(file, line);
+    *(size_t*)block = site;
+    mm_site[site].alloc_num ++;
+    mm_site[site].live_size += tlsf_block_size(block);
+#elif (MM_CACHE_ENABLE)
+    *(size_t*)block = mm_cache_class(heap, tlsf_block_size(block) - MM_HEAD_SIZE);
+#endif
+
+    memset(block + MM_HEAD_SIZE, 0, size);
+    return block + MM_HEAD_SIZE;
+}
+
+
+/**
+ * @brief  memory free
+ * @param  p  the pointer of request size of memory
+ * @return none
+ */
+static void mm_free(void *p)
+{
+    uint8_t *block = (uint8_t*)p - MM_HEAD_SIZE;
+    sgl_mm_heap_t *heap = mm_heap_of(block);
+
+#if (CONFIG_SGL_MM_TRACE)
+    size_t site = *(size_t*)block;
+    mm_site[site].free_num ++;
+    mm_site[site].live_size -= tlsf_block_size(block);
+#endif
+
+    mm_account_free(heap, tlsf_block_size(block));
+    tlsf_free(heap->tlsf, block);
+}
+
+
+/**
+ * @brief  memory realloc with call site
+ * @param  p      the pointer of request size of memory
+ * @param  size   request size of memory
+ * @param  file   file name of call site, NULL means unknown
+ * @param  line   line number of call site
+ * @return point to memory, NULL means failed and the old memory is untouched
+ * @note   the memory stays in its heap, it's moved to other heaps only if its heap is full
+ */
+static void* mm_realloc(void *p, size_t size, const char *file, int line)
+{
+    uint8_t *block, *ret;
+    sgl_mm_heap_t *heap;
+
+    if (p == NULL) {
+        return mm_malloc(size, SGL_MM_HEAP_FAST, file, line);
+    }
+
+    if (size == 0) {
+        mm_free(p);
+        return NULL;
+    }
+
+    block = (uint8_t*)p - MM_HEAD_SIZE;
+    heap = mm_heap_of(block);
+    size_t old_size = tlsf_block_size(block);
+
+    ret = tlsf_realloc(heap->tlsf, block, size + MM_HEAD_SIZE);
+    if (ret == NULL) {
+        /* the moved memory is counted as an allocation of this call site */
+        ret = mm_malloc(size, (uint8_t)(heap - mm_heap), file, line);
+        if (ret != NULL) {
+            memcpy(ret, p, sgl_min(old_size - MM_HEAD_SIZE, size));
+            mm_free(p);
+        }
+        return ret;
+    }
+
+    /* the moved memory is checked by mm_malloc(), so only the memory in place is checked here */
+    mm_steady_check(size, file, line);
+
+    /* realloc is counted as a free and an allocation, the header overhead is not changed */
+    mm_account_free(heap, old_size);
+    mm_account_alloc(heap, tlsf_block_size(ret));
+
+#if (CONFIG_SGL_MM_TRACE)
+    /* the block keeps the site of first allocation */
+    size_t site = *(size_t*)ret;
+    mm_site[site].live_size = mm_site[site].live_size - old_size + tlsf_block_size(ret);
+#elif (MM_CACHE_ENABLE)
+    *(size_t*)ret = mm_cache_class(heap, tlsf_block_size(ret) - MM_HEAD_SIZE);
+#endif
+
+    return ret + MM_HEAD_SIZE;
+}
+
+
+#if (MM_CACHE_ENABLE)
+/**
+ * @brief  get thread cache of current thread
+ * @param  none
+ * @return thread cache, NULL means current thread has no cache
+ */
+static inline sgl_mm_cache_t* mm_cache_get(void)
+{
+    int id = mm_ops.thread_id != NULL ? mm_ops.thread_id() : -1;
+
+    return (id >= 0 && id < CONFIG_SGL_MM_THREAD_NUM) ? &mm_cache[id] : NULL;
+}
+
+
+/**
+ * @brief  give back free blocks of thread cache class to fast heap, the lock should be held
+ * @param  cache  thread cache
+ * @param  cls  class of thread cache
+ * @param  keep  number of blocks that are kept in cache
+ * @return none
+ */
+static void mm_cache_spill(sgl_mm_cache_t *cache, size_t cls, size_t keep)
+{
+    sgl_mm_heap_t *heap = &mm_heap[SGL_MM_HEAP_FAST];
+    uint8_t *block;
+
+    while (cache->count[cls] > keep) {
+        block = (uint8_t*)cache->free_list[cls] - MM_HEAD_SIZE;
+        cache->free_list[cls] = *(void**)(block + MM_HEAD_SIZE);
+        cache->count[cls] --;
+
+        mm_account_free(heap, tlsf_block_size(block));
+        tlsf_free(heap->tlsf, block);
+    }
+}
+
+
+/**
+ * @brief  memory alloc from thread cache, the cache is refilled from fast heap by one lock
+ * @param  size  request size of memory
+ * @return point to request memory address, NULL means it should be allocated from heaps
+ */
+static void* mm_cache_alloc(size_t size)
+{
+    sgl_mm_cache_t *cache = mm_cache_get();
+    sgl_mm_heap_t *heap = &mm_heap[SGL_MM_HEAP_FAST];
+    uint8_t *block;
+    int cls = 0;
+    void *p;
+
+    if (cache == NULL) {
+        return NULL;
+    }
+
+    while (MM_CACHE_SIZE(cls) < size) {
+        cls ++;
+    }
+
+    if (cache->free_list[cls] == NULL) {
+        MM_LOCK();
+        for (int i = 0; i < (CONFIG_SGL_MM_CACHE_DEPTH + 1) / 2 && heap->tlsf != NULL; i++) {
+            block = tlsf_malloc(heap->tlsf, MM_CACHE_SIZE(cls) + MM_HEAD_SIZE);
+            if (block == NULL) {
+                break;
+            }
+
+            mm_account_alloc(heap, tlsf_block_size(block));
+            *(size_t*)block = cls;
+            *(void**)(block + MM_HEAD_SIZE) = cache->free_list[cls];
+            cache->free_list[cls] = block + MM_HEAD_SIZE;
+            cache->count[cls] ++;
+        }
+        MM_UNLOCK();
+
+        if (cache->free_list[cls] == NULL) {
+            return NULL;
+        }
+    }
+
+    p = cache->free_list[cls];
+    cache->free_list[cls] = *(void**)p;
+    cache->count[cls] --;
+
+    memset(p, 0, size);
+    return p;
+}
+
+
+/**
+ * @brief  memory free into thread cache, the half of cache is spilled to fast heap by one lock if it's full
+ * @param  p  the pointer of request size of memory
+ * @return true means memory is cached, false means it should be freed into heaps
+ */
+static bool mm_cache_free(void *p)
+{
+    sgl_mm_cache_t *cache = mm_cache_get();
+    size_t cls = *(size_t*)((uint8_t*)p - MM_HEAD_SIZE);
+
+    if (cache == NULL || cls >= MM_CACHE_CLASS_NUM) {
+        return false;
+    }
+
+    if (cache->count[cls] >= CONFIG_SGL_MM_CACHE_DEPTH) {
+        MM_LOCK();
+        mm_cache_spill(cache, cls, CONFIG_SGL_MM_CACHE_DEPTH / 2);
+        MM_UNLOCK();
+    }
+
+    *(void**)p = cache->free_list[cls];
+    cache->free_list[cls] = p;
+    cache->count[cls] ++;
+    return true;
+}
+#endif
+
+
+/**
+ * @brief  memory alloc that is safe for threads, the thread cache is tried first
+ * @param  size   request size of memory
+ * @param  hint   hinted heap
+ * @param  file   file name of call site, NULL means unknown
+ * @param  line   line number of call site
+ * @return point to request memory address
+ */
+static void* mm_malloc_sync(size_t size, uint8_t hint, const char *file, int line)
+{
+    void *p;
+
+#if (MM_CACHE_ENABLE)
+    if (hint == SGL_MM_HEAP_FAST && size <= MM_CACHE_SIZE(MM_CACHE_CLASS_NUM - 1)) {
+        p = mm_cache_alloc(size);
+        if (p != NULL) {
+            /* the hit is checked here and the miss by mm_malloc(), the count is under lock */
+            if (unlikely(mm_steady)) {
+                MM_LOCK();
+                mm_steady_check(size, file, line);
+                MM_UNLOCK();
+            }
+            return p;
+        }
+    }
+#endif
+
+    MM_LOCK();
+    p = mm_malloc(size, hint, file, line);
+    MM_UNLOCK();
+    return p;
+}
+
+
+/**
+ * @brief  memory realloc that is safe for threads
+ * @param  p      the pointer of request size of memory
+ * @param  size   request size of memory
+ * @param  file   file name of call site, NULL means unknown
+ * @param  line   line number of call site
+ * @return point to memory, NULL means failed and the old memory is untouched
+ */
+static void* mm_realloc_sync(void *p, size_t size, const char *file, int line)
+{
+    void *ret;
+
+    if (p == NULL) {
+        return mm_malloc_sync(size, SGL_MM_HEAP_FAST, file, line);
+    }
+
+    MM_LOCK();
+    ret = mm_realloc(p, size, file, line);
+    MM_UNLOCK();
+    return ret;
 }
 
 
+#if (CONFIG_SGL_MM_TRACE)
+/**
+ * @brief  memory alloc with call site, it's used by sgl_malloc() in trace mode
+ * @param  size   request size of memory
+ * @param  file   file name of call site
+ * @param  line   line number of call site
+ * @return point to request memory address
+ */
+void* sgl_malloc_trace(size_t size, const char *file, int line)
+{
+    return mm_malloc_sync(size, SGL_MM_HEAP_FAST, file, line);
+}
+
+
+/**
+ * @brief  memory alloc from hinted heap with call site, it's used by sgl_malloc_hint() in trace mode
+ * @param  size   request size of memory
+ * @param  heap   hinted heap, such as SGL_MM_HEAP_FAST or SGL_MM_HEAP_BULK
+ * @param  file   file name of call site
+ * @param  line   line number of call site
+ * @return point to request memory address
+ */
+void* sgl_malloc_hint_trace(size_t size, uint8_t heap, const char *file, int line)
+{
+    return mm_malloc_sync(size, heap, file, line);
+}
+
+
+/**
+ * @brief  memory realloc with call site, it's used by sgl_realloc() in trace mode
+ * @param  p      the pointer of request size of memory
+ * @param  size   request size of memory
+ * @param  file   file name of call site
+ * @param  line   line number of call site
+ * @return point to memory, NULL means failed and the old memory is untouched
+ */
+void* sgl_realloc_trace(void *p, size_t size, const char *file, int line)
+{
+    return mm_realloc_sync(p, size, file, line);
+}
+
+#else
 /**
  * @brief  memory alloc, the function is unsafe, you should ensure that 
  *         the requested size is smaller than the free size of memory
@@ -56,12 +824,24 @@ void sgl_mm_add_pool(void *mem_start, size_t len)
  * @param  size   request size of memory
  * 
  * @return point to request memory address
+ * @note   the memory is allocated from fast heap, see sgl_malloc_hint()
 */
 void* sgl_malloc(size_t size)
 {
-    void *p = malloc(size);
-    memset(p, 0, size);
-    return p;
+    return mm_malloc_sync(size, SGL_MM_HEAP_FAST, NULL, 0);
+}
+
+
+/**
+ * @brief  memory alloc from hinted heap
+ * @param  size   request size of memory
+ * @param  heap   hinted heap, such as SGL_MM_HEAP_FAST or SGL_MM_HEAP_BULK
+ * @return point to request memory address
+ * @note   the other heaps are tried in order if the hinted heap has no pool or is full
+ */
+void* sgl_malloc_hint(size_t size, uint8_t heap)
+{
+    return mm_malloc_sync(size, heap, NULL, 0);
 }
 
 
@@ -70,11 +850,14 @@ void* sgl_malloc(size_t size)
  *         the requested size is smaller than the free size of memory
  * @param  p      the pointer of request size of memory
  * @param  size   request size of memory
+ * @return point to memory, NULL means failed and the old memory is untouched
+ * @note   the memory grows in place if the next block is free
  */
 void* sgl_realloc(void *p, size_t size)
 {
-    return realloc(p, size);
+    return mm_realloc_sync(p, size, NULL, 0);
 }
+#endif // !CONFIG_SGL_MM_TRACE
 
 
 /**
@@ -86,17 +869,394 @@ void* sgl_realloc(void *p, size_t size)
 */
 void sgl_free(void *p)
 {
-    //mem.used_size -= ;
-    free(p);
+    if (p == NULL) {
+        return;
+    }
+
+#if (MM_CACHE_ENABLE)
+    if (mm_cache_free(p)) {
+        return;
+    }
+#endif
+
+    MM_LOCK();
+    mm_free(p);
+    MM_UNLOCK();
 }
 
 
+/**
+ * @brief  update the rates of memory monitor
+ * @param  m  memory monitor
+ * @param  max_free  size of the largest free block
+ * @return none
+ */
+static void mm_monitor_update(sgl_mm_monitor_t *m, size_t max_free)
+{
+    if (m->total_size == 0) {
+        return;
+    }
+
+    int integer = (m->used_size * 100) / m->total_size;
+    int decimal = (m->used_size * 10000) / m->total_size - (integer * 100);
+    m->used_rate = integer << 8 | decimal;
+    m->free_size = m->total_size - m->used_size;
+
+    /* the footprint of largest free block includes its header */
+    m->max_free_size = max_free;
+    if (m->free_size > 0) {
+        size_t frag = m->free_size - sgl_min(m->free_size, m->max_free_size + tlsf_alloc_overhead());
+        integer = (frag * 100) / m->free_size;
+        decimal = (frag * 10000) / m->free_size - (integer * 100);
+        m->frag_rate = integer << 8 | decimal;
+    }
+    else {
+        m->frag_rate = 0;
+    }
+}
+
+
+/**
+ * @brief  get memory monitor info
+ * 
+ * @param  none
+ * @return memory monitor info
+ */
 sgl_mm_monitor_t sgl_mm_get_monitor(void)
 {
-    int integer = (mem.used_size * 100) / mem.total_size;
-    int decimal = (mem.used_size * 10000) / mem.total_size - (integer * 100);
-    mem.used_rate = integer << 8 | decimal;
-    mem.free_size = mem.total_size - mem.used_size;
+    sgl_mm_monitor_t info;
+    size_t max_free = 0;
 
-    return mem;
+    MM_LOCK();
+    for (int i = 0; i < CONFIG_SGL_MM_HEAP_NUM; i++) {
+        if (mm_heap[i].tlsf != NULL) {
+            max_free = sgl_max(max_free, tlsf_block_size_largest(mm_heap[i].tlsf));
+        }
+    }
+
+    mm_monitor_update(&mem, max_free);
+    info = mem;
+    MM_UNLOCK();
+
+    return info;
+}
+
+
+/**
+ * @brief  get memory monitor info of heap
+ * @param  heap  heap, such as SGL_MM_HEAP_FAST or SGL_MM_HEAP_BULK
+ * @return memory monitor info of heap, the fields of frame, arena and steady are not used
+ */
+sgl_mm_monitor_t sgl_mm_get_heap_monitor(uint8_t heap)
+{
+    SGL_ASSERT(heap < CONFIG_SGL_MM_HEAP_NUM);
+    sgl_mm_heap_t *h = &mm_heap[heap];
+    sgl_mm_monitor_t info;
+
+    MM_LOCK();
+    if (h->tlsf != NULL) {
+        mm_monitor_update(&h->monitor, tlsf_block_size_largest(h->tlsf));
+    }
+
+    info = h->monitor;
+    MM_UNLOCK();
+
+    return info;
+}
+
+
+/**
+ * @brief  mark the end of frame, the counts of allocation in frame are saved and reset
+ * @param  none
+ * @return none
+ */
+void sgl_mm_frame_mark(void)
+{
+    MM_LOCK();
+    mem.frame_alloc = frame_alloc;
+    mem.frame_free = frame_free;
+    frame_alloc = frame_free = 0;
+    MM_UNLOCK();
+}
+
+
+/**
+ * @brief  initialize frame arena
+ * @param  mem_start  start address of arena
+ * @param  len  length of arena
+ * @return none
+ */
+void sgl_frame_arena_init(void *mem_start, size_t len)
+{
+    size_t ofs = (SGL_MM_ARENA_ALIGN - ((uintptr_t)mem_start & (SGL_MM_ARENA_ALIGN - 1))) & (SGL_MM_ARENA_ALIGN - 1);
+
+    sgl_frame_arena_reset();
+    frame_arena.buf = (uint8_t*)mem_start + ofs;
+    frame_arena.size = len > ofs ? len - ofs : 0;
+    mem.arena_size = frame_arena.size;
+}
+
+
+/**
+ * @brief  alloc transient memory that lives until the end of frame
+ * @param  size  request size of memory
+ * @return point to memory, it's not set to zero, NULL means out of memory
+ * @note   the memory is bumped from frame arena, it's spilled to heap if arena is full,
+ *         it should not be freed, all of it is released by sgl_frame_arena_reset()
+ */
+void* sgl_frame_alloc(size_t size)
+{
+    size_t head = SGL_MM_ARENA_ROUND(sizeof(void*));
+    uint8_t *p;
+
+    size = SGL_MM_ARENA_ROUND(size);
+
+    if (frame_arena.size - frame_arena.pos >= size) {
+        p = frame_arena.buf + frame_arena.pos;
+        frame_arena.pos += size;
+    }
+    else {
+        /* the spilled block keeps the link in an aligned header */
+        p = mm_malloc_sync(size + head, SGL_MM_HEAP_FAST, NULL, 0);
+        if (p == NULL) {
+            return NULL;
+        }
+
+        *(void**)p = frame_arena.spill;
+        frame_arena.spill = p;
+        frame_arena.spill_size += size;
+        mem.arena_spill ++;
+        p += head;
+    }
+
+    mem.arena_peak = sgl_max(mem.arena_peak, frame_arena.pos + frame_arena.spill_size);
+    return p;
+}
+
+
+/**
+ * @brief  release all memory of frame arena, it's called at the end of each frame
+ * @param  none
+ * @return none
+ */
+void sgl_frame_arena_reset(void)
+{
+    void *next;
+
+    while (frame_arena.spill != NULL) {
+        next = *(void**)frame_arena.spill;
+        sgl_free(frame_arena.spill);
+        frame_arena.spill = next;
+    }
+
+    frame_arena.pos = 0;
+    frame_arena.spill_size = 0;
+}
+
+
+/**
+ * @brief  set steady state, any allocation in steady state is reported as error and asserted
+ * @param  steady  true means steady state, false means allocation is allowed
+ * @return none
+ * @note   it's used to prove that render loop never allocates, it should be set after
+ *         the first frames that build caches and layouts. the error and assert are debug
+ *         only, the allocations are counted by steady_count of monitor in release too
+ */
+void sgl_mm_set_steady(bool steady)
+{
+    mm_steady = steady;
+}
+
+
+/**
+ * @brief  print memory report, the memory that is still allocated is printed per call site
+ *         in trace mode
+ * @param  none
+ * @return none
+ * @note   the objects of slab are printed per class, because they are not traced by call site
+ */
+void sgl_mm_report(void)
+{
+    sgl_mm_monitor_t info = sgl_mm_get_monitor();
+    sgl_slab_monitor_t slab;
+    SGL_UNUSED(info);
+    SGL_UNUSED(slab);
+
+    SGL_LOG_INFO("memory: used %d, peak %d, live blocks %d, steady allocations %d", (int)info.used_size,
+                 (int)info.peak_size, (int)(info.alloc_count - info.free_count), (int)info.steady_count);
+
+    for (int i = 0; i < CONFIG_SGL_MM_HEAP_NUM; i++) {
+        info = sgl_mm_get_heap_monitor(i);
+        if (info.total_size > 0) {
+            SGL_LOG_INFO("  heap %d: total %d, used %d, peak %d, fallback %d", i, (int)info.total_size,
+                         (int)info.used_size, (int)info.peak_size, (int)info.fallback_count);
+        }
+    }
+
+    for (int i = 0; i < CONFIG_SGL_SLAB_CLASS_NUM && slab_class[i].monitor.obj_size > 0; i++) {
+        slab = sgl_slab_get_monitor(i);
+        SGL_LOG_INFO("  slab %d: size %d, live %d objects, peak %d, total %d", i, (int)slab.obj_size,
+                     (int)slab.used_num, (int)slab.peak_num, (int)slab.total_num);
+    }
+
+#if (CONFIG_SGL_MM_TRACE)
+    /* the internal site is not printed, the slab chunks are printed per class above */
+    for (int i = 0; i <= MM_SITE_OTHER; i++) {
+        if (mm_site[i].alloc_num != mm_site[i].free_num) {
+            SGL_LOG_INFO("  %s:%d live %d blocks %d bytes", mm_site[i].file ? mm_site[i].file : "other",
+                         mm_site[i].line, (int)(mm_site[i].alloc_num - mm_site[i].free_num),
+                         (int)mm_site[i].live_size);
+        }
+    }
+#endif
+}
+
+
+#if (CONFIG_SGL_MM_THREAD_NUM)
+/**
+ * @brief  register lock operations of memory, it should be called before the threads use memory
+ * @param  lock  lock the shared heaps, such as taking a mutex
+ * @param  unlock  unlock the shared heaps
+ * @param  thread_id  get index of thread cache that is less than CONFIG_SGL_MM_THREAD_NUM,
+ *                    negative means thread has no cache, NULL means no thread has cache
+ * @return none
+ */
+void sgl_mm_lock_register(void (*lock)(void), void (*unlock)(void), int (*thread_id)(void))
+{
+    mm_ops.lock = lock;
+    mm_ops.unlock = unlock;
+    mm_ops.thread_id = thread_id;
+}
+
+
+/**
+ * @brief  give back all free blocks of thread cache to heap, it should be called before thread exits
+ * @param  none
+ * @return none
+ */
+void sgl_mm_cache_flush(void)
+{
+#if (MM_CACHE_ENABLE)
+    sgl_mm_cache_t *cache = mm_cache_get();
+
+    if (cache == NULL) {
+        return;
+    }
+
+    MM_LOCK();
+    for (int i = 0; i < MM_CACHE_CLASS_NUM; i++) {
+        mm_cache_spill(cache, i, 0);
+    }
+    MM_UNLOCK();
+#endif
+}
+#endif // !CONFIG_SGL_MM_THREAD_NUM
+
+
+/**
+ * @brief  get slab class of size, the class is created if it does not exist
+ * @param  size  size of object
+ * @return index of class, -1 means all classes are used by other sizes
+ */
+int sgl_slab_get_class(size_t size)
+{
+    size_t align = tlsf_align_size();
+
+    /* the free object holds a link, and every object in chunk should be aligned */
+    size = (sgl_max(size, sizeof(void*)) + align - 1) & ~(align - 1);
+    int cls = -1;
+
+    MM_LOCK();
+    for (int i = 0; i < CONFIG_SGL_SLAB_CLASS_NUM; i++) {
+        if (slab_class[i].monitor.obj_size == size) {
+            cls = i;
+            break;
+        }
+
+        if (slab_class[i].monitor.obj_size == 0) {
+            slab_class[i].monitor.obj_size = size;
+            cls = i;
+            break;
+        }
+    }
+    MM_UNLOCK();
+
+    return cls;
+}
+
+
+/**
+ * @brief  alloc object from slab class
+ * @param  cls  index of class
+ * @return point to object that is set to zero, NULL means out of memory
+ * @note   the free list is refilled by a chunk of CONFIG_SGL_SLAB_CHUNK_NUM objects
+ *         from heap, the chunk is never given back, so it is reused by same size only
+ */
+void* sgl_slab_alloc(int cls)
+{
+    SGL_ASSERT(cls >= 0 && cls < CONFIG_SGL_SLAB_CLASS_NUM);
+    sgl_slab_class_t *slab = &slab_class[cls];
+    size_t size = slab->monitor.obj_size;
+    uint8_t *chunk;
+    void *p;
+
+    MM_LOCK();
+    if (slab->free_list == NULL) {
+        /* the chunk is internal, the objects in use are reported per class */
+        chunk = mm_malloc(size * CONFIG_SGL_SLAB_CHUNK_NUM, SGL_MM_HEAP_FAST, NULL, 0);
+        if (chunk == NULL) {
+            MM_UNLOCK();
+            return NULL;
+        }
+
+        for (int i = CONFIG_SGL_SLAB_CHUNK_NUM - 1; i >= 0; i--) {
+            *(void**)(chunk + i * size) = slab->free_list;
+            slab->free_list = chunk + i * size;
+        }
+        slab->monitor.total_num += CONFIG_SGL_SLAB_CHUNK_NUM;
+    }
+
+    p = slab->free_list;
+    slab->free_list = *(void**)p;
+    slab->monitor.used_num ++;
+    slab->monitor.peak_num = sgl_max(slab->monitor.peak_num, slab->monitor.used_num);
+    MM_UNLOCK();
+
+    memset(p, 0, size);
+    return p;
+}
+
+
+/**
+ * @brief  free object into slab class
+ * @param  cls  index of class
+ * @param  p  point to object
+ * @return none
+ */
+void sgl_slab_free(int cls, void *p)
+{
+    SGL_ASSERT(cls >= 0 && cls < CONFIG_SGL_SLAB_CLASS_NUM);
+    sgl_slab_class_t *slab = &slab_class[cls];
+
+    if (p == NULL) {
+        return;
+    }
+
+    MM_LOCK();
+    *(void**)p = slab->free_list;
+    slab->free_list = p;
+    slab->monitor.used_num --;
+    MM_UNLOCK();
+}
+
+
+/**
+ * @brief  get slab class monitor info
+ * @param  cls  index of class
+ * @return slab class monitor info
+ */
+sgl_slab_monitor_t sgl_slab_get_monitor(int cls)
+{
+    SGL_ASSERT(cls >= 0 && cls < CONFIG_SGL_SLAB_CLASS_NUM);
+    return slab_class[cls].monitor;
 }
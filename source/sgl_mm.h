@@ -23,24 +23,74 @@
 extern "C" {
 #endif
 
+/* heap of fast memory, such as internal SRAM, it's the default heap */
+#define  SGL_MM_HEAP_FAST                        (0)
+/* heap of large and slow memory, such as external PSRAM */
+#define  SGL_MM_HEAP_BULK                        (1)
+/* alignment of frame arena and page arena, it's enough for all basic types */
+#define  SGL_MM_ARENA_ALIGN                      (8)
+#define  SGL_MM_ARENA_ROUND(size)                (((size) + SGL_MM_ARENA_ALIGN - 1) & ~(size_t)(SGL_MM_ARENA_ALIGN - 1))
+
+
 /**
  * @brief  memory monitor info
  * @total_size: total size of memory
  * @free_size: free size of memory
- * @used_size: used size of memory
+ * @used_size: used size of memory, it includes the overhead of allocator
  * @used_rate: used rate of memory:
  *             |  8 bit  |  8 bit |          
  *             |   int   |   dec  |
+ * @peak_size: max used size of memory since init
+ * @max_free_size: size of the largest free block
+ * @frag_rate: fragmentation of free memory, it's the rate of free memory that is not in
+ *             the largest free block, the format is same as used_rate
+ * @alloc_count: number of allocations since init, the allocations that hit thread cache are not counted
+ * @free_count: number of frees since init, the frees into thread cache are not counted
+ * @frame_alloc: number of allocations in last frame
+ * @frame_free: number of frees in last frame
+ * @arena_size: size of frame arena
+ * @arena_peak: max size that is used in a frame, it includes the spilled memory
+ * @arena_spill: number of allocations that are spilled to heap since init
+ * @fallback_count: number of allocations that are hinted to the heap but placed in other heaps
+ * @steady_count: number of allocations in steady state since init, it's counted in release too
  */
 typedef struct sgl_mm_monitor {
     size_t  total_size;
     size_t  free_size;
     size_t  used_size;
     size_t  used_rate;
+    size_t  peak_size;
+    size_t  max_free_size;
+    size_t  frag_rate;
+    size_t  alloc_count;
+    size_t  free_count;
+    size_t  frame_alloc;
+    size_t  frame_free;
+    size_t  arena_size;
+    size_t  arena_peak;
+    size_t  arena_spill;
+    size_t  fallback_count;
+    size_t  steady_count;
 
 } sgl_mm_monitor_t;
 
 
+/**
+ * @brief  slab class monitor info
+ * @obj_size: size of object in class, 0 means class is not used
+ * @total_num: number of objects that are carved from heap
+ * @used_num: number of objects that are in use
+ * @peak_num: max number of objects that are in use
+ */
+typedef struct sgl_slab_monitor {
+    size_t  obj_size;
+    size_t  total_num;
+    size_t  used_num;
+    size_t  peak_num;
+
+} sgl_slab_monitor_t;
+
+
 /**
  * @brief  initialize memory pool
  * @param  mem_start  start address of memory pool
@@ -50,13 +100,62 @@ void sgl_mm_init(void *mem_start, size_t len);
 
 
 /**
- * @brief  add memory pool
+ * @brief  add memory pool to fast heap
  * @param  mem_start  start address of memory pool
  * @param  len  length of memory pool
  */
 void sgl_mm_add_pool(void *mem_start, size_t len);
 
 
+/**
+ * @brief  add memory pool to heap, it should be called after sgl_mm_init()
+ * @param  heap  heap of pool, such as SGL_MM_HEAP_FAST or SGL_MM_HEAP_BULK
+ * @param  mem_start  start address of memory pool
+ * @param  len  length of memory pool
+ * @return none
+ * @note   at most CONFIG_SGL_MM_POOL_NUM pools can be added, including the pool of sgl_mm_init()
+ */
+void sgl_mm_add_heap_pool(uint8_t heap, void *mem_start, size_t len);
+
+
+#if (CONFIG_SGL_MM_TRACE)
+/**
+ * @brief  memory alloc with call site, it's used by sgl_malloc() in trace mode
+ * @param  size   request size of memory
+ * @param  file   file name of call site
+ * @param  line   line number of call site
+ * @return point to request memory address
+ */
+void* sgl_malloc_trace(size_t size, const char *file, int line);
+
+
+/**
+ * @brief  memory realloc with call site, it's used by sgl_realloc() in trace mode
+ * @param  p      the pointer of request size of memory
+ * @param  size   request size of memory
+ * @param  file   file name of call site
+ * @param  line   line number of call site
+ * @return point to memory, NULL means failed and the old memory is untouched
+ */
+void* sgl_realloc_trace(void *p, size_t size, const char *file, int line);
+
+
+/**
+ * @brief  memory alloc from hinted heap with call site, it's used by sgl_malloc_hint() in trace mode
+ * @param  size   request size of memory
+ * @param  heap   hinted heap, such as SGL_MM_HEAP_FAST or SGL_MM_HEAP_BULK
+ * @param  file   file name of call site
+ * @param  line   line number of call site
+ * @return point to request memory address
+ */
+void* sgl_malloc_hint_trace(size_t size, uint8_t heap, const char *file, int line);
+
+
+#define  sgl_malloc(size)                        sgl_malloc_trace(size, __FILE__, __LINE__)
+#define  sgl_malloc_hint(size, heap)             sgl_malloc_hint_trace(size, heap, __FILE__, __LINE__)
+#define  sgl_realloc(p, size)                    sgl_realloc_trace(p, size, __FILE__, __LINE__)
+
+#else
 /**
  * @brief  memory alloc, the function is unsafe, you should ensure that 
  *         the requested size is smaller than the free size of memory
@@ -64,17 +163,31 @@ void sgl_mm_add_pool(void *mem_start, size_t len);
  * @param  size   request size of memory
  * 
  * @return point to request memory address
+ * @note   the memory is allocated from fast heap, see sgl_malloc_hint()
 */
 void* sgl_malloc(size_t size);
 
 
+/**
+ * @brief  memory alloc from hinted heap
+ * @param  size   request size of memory
+ * @param  heap   hinted heap, such as SGL_MM_HEAP_FAST or SGL_MM_HEAP_BULK
+ * @return point to request memory address
+ * @note   the other heaps are tried in order if the hinted heap has no pool or is full
+ */
+void* sgl_malloc_hint(size_t size, uint8_t heap);
+
+
 /**
  * @brief  memory realloc, the function is unsafe, you should ensure that 
  *         the requested size is smaller than the free size of memory
  * @param  p      the pointer of request size of memory
  * @param  size   request size of memory
+ * @return point to memory, NULL means failed and the old memory is untouched
+ * @note   the memory grows in place if the next block is free
  */
 void* sgl_realloc(void *p, size_t size);
+#endif // !CONFIG_SGL_MM_TRACE
 
 
 /**
@@ -96,6 +209,128 @@ void sgl_free(void *p);
 sgl_mm_monitor_t sgl_mm_get_monitor(void);
 
 
+/**
+ * @brief  get memory monitor info of heap
+ * @param  heap  heap, such as SGL_MM_HEAP_FAST or SGL_MM_HEAP_BULK
+ * @return memory monitor info of heap, the fields of frame, arena and steady are not used
+ */
+sgl_mm_monitor_t sgl_mm_get_heap_monitor(uint8_t heap);
+
+
+/**
+ * @brief  mark the end of frame, the counts of allocation in frame are saved and reset
+ * @param  none
+ * @return none
+ */
+void sgl_mm_frame_mark(void);
+
+
+/**
+ * @brief  initialize frame arena
+ * @param  mem_start  start address of arena
+ * @param  len  length of arena
+ * @return none
+ */
+void sgl_frame_arena_init(void *mem_start, size_t len);
+
+
+/**
+ * @brief  alloc transient memory that lives until the end of frame
+ * @param  size  request size of memory
+ * @return point to memory, it's not set to zero, NULL means out of memory
+ * @note   the memory is bumped from frame arena, it's spilled to heap if arena is full,
+ *         it should not be freed, all of it is released by sgl_frame_arena_reset()
+ */
+void* sgl_frame_alloc(size_t size);
+
+
+/**
+ * @brief  release all memory of frame arena, it's called at the end of each frame
+ * @param  none
+ * @return none
+ */
+void sgl_frame_arena_reset(void);
+
+
+/**
+ * @brief  set steady state, any allocation in steady state is reported as error and asserted
+ * @param  steady  true means steady state, false means allocation is allowed
+ * @return none
+ * @note   it's used to prove that render loop never allocates, it should be set after
+ *         the first frames that build caches and layouts. the error and assert are debug
+ *         only, the allocations are counted by steady_count of monitor in release too
+ */
+void sgl_mm_set_steady(bool steady);
+
+
+/**
+ * @brief  print memory report, the memory that is still allocated is printed per call site
+ *         in trace mode
+ * @param  none
+ * @return none
+ */
+void sgl_mm_report(void);
+
+
+#if (CONFIG_SGL_MM_THREAD_NUM)
+/**
+ * @brief  register lock operations of memory, it should be called before the threads use memory
+ * @param  lock  lock the shared heaps, such as taking a mutex
+ * @param  unlock  unlock the shared heaps
+ * @param  thread_id  get index of thread cache that is less than CONFIG_SGL_MM_THREAD_NUM,
+ *                    negative means thread has no cache, NULL means no thread has cache
+ * @return none
+ * @note   the small allocations of fast heap are served by the free lists of thread cache without
+ *         lock, the lock is only taken to refill or spill the cache, and for other allocations.
+ *         the thread cache is not used in trace mode
+ */
+void sgl_mm_lock_register(void (*lock)(void), void (*unlock)(void), int (*thread_id)(void));
+
+
+/**
+ * @brief  give back all free blocks of thread cache to heap, it should be called before thread exits
+ * @param  none
+ * @return none
+ */
+void sgl_mm_cache_flush(void);
+#endif // !CONFIG_SGL_MM_THREAD_NUM
+
+
+/**
+ * @brief  get slab class of size, the class is created if it does not exist
+ * @param  size  size of object
+ * @return index of class, -1 means all classes are used by other sizes
+ */
+int sgl_slab_get_class(size_t size);
+
+
+/**
+ * @brief  alloc object from slab class
+ * @param  cls  index of class
+ * @return point to object that is set to zero, NULL means out of memory
+ * @note   the free list is refilled by a chunk of CONFIG_SGL_SLAB_CHUNK_NUM objects
+ *         from heap, the chunk is never given back, so it is reused by same size only
+ */
+void* sgl_slab_alloc(int cls);
+
+
+/**
+ * @brief  free object into slab class
+ * @param  cls  index of class
+ * @param  p  point to object
+ * @return none
+ */
+void sgl_slab_free(int cls, void *p);
+
+
+/**
+ * @brief  get slab class monitor info
+ * @param  cls  index of class
+ * @return slab class monitor info
+ */
+sgl_slab_monitor_t sgl_slab_get_monitor(int cls);
+
+
 #ifdef __cplusplus
 }
 #endif
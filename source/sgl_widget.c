@@ -27,10 +27,58 @@
 static void sgl_rectangle_construct_cb(sgl_surf_t *surf, sgl_obj_t* obj, sgl_area_t *area)
 {
     sgl_rectangle_t *rect = (sgl_rectangle_t*)obj;
+    sgl_shadow_mask_t *mask = rect->desc.shadow_mask;
+
+    /* the mask is got again only if the radius of shadow shape is changed by resizing */
+    if (mask != NULL && mask->radius != sgl_draw_rect_shadow_radius(&obj->coords, &rect->desc)) {
+        sgl_rect_update_shadow(rect);
+    }
+
     sgl_draw_rect(surf, area, &obj->coords, &rect->desc);
 }
 
 
+/**
+ * @brief rectangle destroy callback, the shadow mask is released
+ * @param  obj: object
+ * @retval none
+ */
+static void sgl_rectangle_destroy_cb(sgl_obj_t* obj)
+{
+    sgl_rectangle_t *rect = (sgl_rectangle_t*)obj;
+    sgl_draw_shadow_mask_put(rect->desc.shadow_mask);
+    rect->desc.shadow_mask = NULL;
+}
+
+
+/**
+ * @brief  setup a rectangle whose storage is cleared
+ * @param  rect: rectangle storage
+ * @param  parent: parent object
+ * @retval rectangle object, NULL means failed
+ */
+static sgl_obj_t* sgl_rect_setup(sgl_rectangle_t *rect, sgl_obj_t* parent)
+{
+    sgl_obj_t *obj = &rect->obj;
+
+    if (sgl_obj_init(&rect->obj, parent)) {
+        return NULL;
+    }
+
+    obj->construct_fn = sgl_rectangle_construct_cb;
+    obj->destroy_fn = sgl_rectangle_destroy_cb;
+
+    rect->desc.alpha = SGL_THEME_ALPHA;
+    rect->desc.color = SGL_THEME_COLOR;
+    rect->desc.border = SGL_THEME_BORDER_WIDTH;
+    rect->desc.border_color = SGL_THEME_BORDER_COLOR;
+    rect->desc.pixmap = NULL;
+    rect->desc.gradient = NULL;
+
+    return obj;
+}
+
+
 /**
  * @brief  create a rectangle
  * @param  parent: parent object
@@ -38,27 +86,61 @@ static void sgl_rectangle_construct_cb(sgl_surf_t *surf, sgl_obj_t* obj, sgl_are
  */
 sgl_obj_t* sgl_rect_create(sgl_obj_t* parent)
 {
-    sgl_rectangle_t *rect = sgl_malloc(sizeof(sgl_rectangle_t));
+    /* object is allocated from slab and all member is set to zero */
+    sgl_rectangle_t *rect = sgl_obj_alloc(sizeof(sgl_rectangle_t), parent);
     if(rect == NULL) {
         SGL_LOG_ERROR("sgl_rect_create: malloc failed");
         return NULL;
     }
 
-    /* set object all member to zero */
+    if (sgl_rect_setup(rect, parent) == NULL) {
+        sgl_obj_free(&rect->obj);
+        return NULL;
+    }
+
+    return &rect->obj;
+}
+
+
+/**
+ * @brief  initialize a rectangle in storage of user, such as static memory
+ * @param  rect: rectangle storage, it's never freed by sgl
+ * @param  parent: parent object
+ * @retval rectangle object, NULL means failed
+ */
+sgl_obj_t* sgl_rect_init(sgl_rectangle_t *rect, sgl_obj_t* parent)
+{
+    SGL_ASSERT(rect != NULL);
+
     memset(rect, 0, sizeof(sgl_rectangle_t));
+    rect->obj.nofree = 1;
 
-    sgl_obj_t *obj = &rect->obj;
-    sgl_obj_init(&rect->obj, parent);
+    return sgl_rect_setup(rect, parent);
+}
 
-    obj->construct_fn = sgl_rectangle_construct_cb;
 
-    rect->desc.alpha = SGL_THEME_ALPHA;
-    rect->desc.color = SGL_THEME_COLOR;
-    rect->desc.border = SGL_THEME_BORDER_WIDTH;
-    rect->desc.border_color = SGL_THEME_BORDER_COLOR;
-    rect->desc.pixmap = NULL;
+/**
+ * @brief  update the shadow mask of rectangle, the mask of old shape is released
+ * @param  rect: rectangle object
+ * @retval none
+ * @note   it's called when the shadow or radius is set, and in drawing only if the radius of
+ *         shadow shape is changed by resizing, so the redraw of same shape never allocates
+ */
+void sgl_rect_update_shadow(sgl_rectangle_t *rect)
+{
+    sgl_draw_rect_t *desc = &rect->desc;
+    sgl_shadow_mask_t *mask = NULL;
 
-    return obj;
+    /* the new mask is got before the old one is released, so the same mask is not rebuilt */
+    if (desc->shadow_width > 0) {
+        mask = sgl_draw_shadow_mask_get(sgl_draw_rect_shadow_radius(&rect->obj.coords, desc), desc->shadow_width / 2);
+        if (mask == NULL) {
+            SGL_LOG_ERROR("sgl_rect_update_shadow: malloc failed");
+        }
+    }
+
+    sgl_draw_shadow_mask_put(desc->shadow_mask);
+    desc->shadow_mask = mask;
 }
 
 
@@ -85,36 +167,116 @@ static void sgl_label_construct_cb(sgl_surf_t *surf, sgl_obj_t* obj, sgl_area_t
         }
     }
 
-    align_pos = sgl_get_text_pos(&obj->coords, label->font, label->text, 0, (sgl_align_type_t)label->align);
+    /* the text is measured only once after the text or font is changed, not in every slice */
+    if (label->relayout) {
+        if (sgl_text_layout_build(&label->layout, label->text, label->font, 0) == 0) {
+            label->relayout = 0;
+        }
+    }
+
+    /* fallback to measure and draw string directly if the layout is failed to build */
+    if (unlikely(label->relayout)) {
+        align_pos = sgl_get_text_pos(&obj->coords, label->font, label->text, 0, (sgl_align_type_t)label->align);
+        sgl_draw_string(surf, area, align_pos.x + label->offset_x, align_pos.y + label->offset_y, label->text, label->color, label->alpha, label->font);
+        return;
+    }
+
+    sgl_size_t obj_size = sgl_obj_get_size(obj);
+    sgl_size_t text_size = {
+        .w = label->layout.width,
+        .h = label->layout.height,
+    };
 
-    sgl_draw_string(surf, area, align_pos.x + label->offset_x, align_pos.y + label->offset_y, label->text, label->color, label->alpha, label->font);
+    align_pos = sgl_get_align_pos(&obj_size, &text_size, (sgl_align_type_t)label->align);
+    align_pos.x += obj->coords.x1 + label->offset_x;
+    align_pos.y += obj->coords.y1 + label->offset_y;
+
+    sgl_draw_text_layout(surf, area, align_pos.x, align_pos.y, &label->layout, label->color, label->alpha, label->font, 0);
 }
 
 
 /**
- * @brief create a label object
+ * @brief destroy the label object, release the cached layout
+ * @param obj pointer to the label object
+ * @return none
+ */
+static void sgl_label_destroy_cb(sgl_obj_t* obj)
+{
+    sgl_label_t *label = (sgl_label_t*)obj;
+    sgl_text_layout_free(&label->layout);
+}
+
+
+/**
+ * @brief setup a label whose storage is cleared
+ * @param label label storage
  * @param parent parent of the label
- * @return pointer to the label object
+ * @return pointer to the label object, NULL means failed
  */
-sgl_obj_t* sgl_label_create(sgl_obj_t* parent)
+static sgl_obj_t* sgl_label_setup(sgl_label_t *label, sgl_obj_t* parent)
 {
-    sgl_label_t *label = sgl_malloc(sizeof(sgl_label_t));
-    if(label == NULL) {
-        SGL_LOG_ERROR("sgl_label_create: malloc failed");
+    sgl_obj_t *obj = &label->obj;
+
+    if (sgl_obj_init(&label->obj, parent)) {
         return NULL;
     }
 
-    /* set object all member to zero */
-    memset(label, 0, sizeof(sgl_label_t));
-
-    sgl_obj_t *obj = &label->obj;
-    sgl_obj_init(&label->obj, parent);
     obj->construct_fn = sgl_label_construct_cb;
+    obj->destroy_fn = sgl_label_destroy_cb;
 
     label->alpha = SGL_ALPHA_MAX;
     label->bg_flag = 0;
     label->color = SGL_THEME_TEXT_COLOR;
     label->text = "";
+    label->relayout = 1;
 
     return obj;
 }
+
+
+/**
+ * @brief create a label object
+ * @param parent parent of the label
+ * @return pointer to the label object
+ */
+sgl_obj_t* sgl_label_create(sgl_obj_t* parent)
+{
+    /* object is allocated from slab and all member is set to zero */
+    sgl_label_t *label = sgl_obj_alloc(sizeof(sgl_label_t), parent);
+    if(label == NULL) {
+        SGL_LOG_ERROR("sgl_label_create: malloc failed");
+        return NULL;
+    }
+
+    if (sgl_label_setup(label, parent) == NULL) {
+        sgl_obj_free(&label->obj);
+        return NULL;
+    }
+
+    return &label->obj;
+}
+
+
+/**
+ * @brief initialize a label object in storage of user, such as static memory
+ * @param label label storage, it's never freed by sgl
+ * @param parent parent of the label
+ * @param glyph glyph buffer of the text layout, NULL means the layout is allocated from heap
+ * @param glyph_num number of glyphs of the buffer, it should be not less than the characters
+ *        of the longest text of label
+ * @return pointer to the label object, NULL means failed
+ * @note the text that does not fit in the glyph buffer is drawn without layout
+ */
+sgl_obj_t* sgl_label_init(sgl_label_t *label, sgl_obj_t* parent, sgl_text_glyph_t *glyph, uint16_t glyph_num)
+{
+    SGL_ASSERT(label != NULL);
+
+    SGL_ASSERT(glyph != NULL || glyph_num == 0);
+
+    memset(label, 0, sizeof(sgl_label_t));
+    label->obj.nofree = 1;
+    label->layout.glyph = (glyph_num > 0 ? glyph : NULL);
+    label->layout.capacity = glyph_num;
+
+    return sgl_label_setup(label, parent);
+}
@@ -50,6 +50,25 @@ typedef struct sgl_rectangle {
 sgl_obj_t* sgl_rect_create(sgl_obj_t* parent);
 
 
+/**
+ * @brief  initialize a rectangle in storage of user, such as static memory
+ * @param  rect: rectangle storage, it's never freed by sgl
+ * @param  parent: parent object
+ * @retval rectangle object, NULL means failed
+ */
+sgl_obj_t* sgl_rect_init(sgl_rectangle_t *rect, sgl_obj_t* parent);
+
+
+/**
+ * @brief  update the shadow mask of rectangle, the mask of old shape is released
+ * @param  rect: rectangle object
+ * @retval none
+ * @note   it's called when the shadow or radius is set, and in drawing only if the radius of
+ *         shadow shape is changed by resizing, so the redraw of same shape never allocates
+ */
+void sgl_rect_update_shadow(sgl_rectangle_t *rect);
+
+
 /**
  * @brief  set rectangle color
  * @param  obj: rectangle object
@@ -87,6 +106,9 @@ static inline void sgl_rect_set_radius(sgl_obj_t *obj, uint8_t radius)
 {
     sgl_rectangle_t *rect = (sgl_rectangle_t *)obj;
     rect->desc.radius = radius;
+    if (rect->desc.shadow_width > 0) {
+        sgl_rect_update_shadow(rect);
+    }
     sgl_obj_set_dirty(obj);
 }
 
@@ -130,10 +152,64 @@ static inline void sgl_rect_set_pixmap(sgl_obj_t *obj, const sgl_pixmap_t *pixma
 }
 
 
+/**
+ * @brief  set rectangle gradient, it is used instead of color
+ * @param  obj: rectangle object
+ * @param  gradient: rectangle gradient, it should be built by sgl_gradient_init(), NULL means no gradient
+ * @retval none
+ */
+static inline void sgl_rect_set_gradient(sgl_obj_t *obj, const sgl_gradient_t *gradient)
+{
+    sgl_rectangle_t *rect = (sgl_rectangle_t *)obj;
+    rect->desc.gradient = gradient;
+    sgl_obj_set_dirty(obj);
+}
+
+
+/**
+ * @brief  set rectangle shadow, the shadow is drawn under the rectangle
+ * @param  obj: rectangle object
+ * @param  color: shadow color
+ * @param  width: blur width of shadow, 0 means no shadow
+ * @param  spread: size that shadow grows out of rectangle
+ * @param  ofs_x: x offset of shadow
+ * @param  ofs_y: y offset of shadow
+ * @param  alpha: shadow alpha
+ * @retval none
+ * @note   the shadow should go out of rectangle by 255 at most, so the spread and then the
+ *         width are limited by the offset
+ */
+static inline void sgl_rect_set_shadow(sgl_obj_t *obj, sgl_color_t color, uint8_t width, uint8_t spread, int8_t ofs_x, int8_t ofs_y, uint8_t alpha)
+{
+    sgl_rectangle_t *rect = (sgl_rectangle_t *)obj;
+    sgl_area_t area = sgl_obj_get_draw_area(obj);
+    int16_t rest = 255 - sgl_max(sgl_abs(ofs_x), sgl_abs(ofs_y));
+
+    /* the old shadow should be cleared, the area out of page is not pushed */
+    if (sgl_area_selfclip(&area, &sgl_screen_act()->coords)) {
+        sgl_dirty_area_push(&area);
+    }
+
+    spread = sgl_min(spread, rest);
+    rest -= spread;
+    rect->desc.shadow_color = color;
+    rect->desc.shadow_width = sgl_min(width, 2 * rest + 1);
+    rect->desc.shadow_spread = spread;
+    rect->desc.shadow_ofs_x = ofs_x;
+    rect->desc.shadow_ofs_y = ofs_y;
+    rect->desc.shadow_alpha = alpha;
+    obj->ext_draw = sgl_draw_rect_shadow_ext(&rect->desc);
+    sgl_rect_update_shadow(rect);
+    sgl_obj_update_bbox(obj);
+    sgl_obj_set_dirty(obj);
+}
+
 /**
  * @brief sgl label object
  * @obj: sgl general object
  * @desc: draw task descriptor
+ * @layout: cached layout of text, it's rebuilt only after the text or font is changed
+ * @relayout: flag of the layout need to rebuild
  */
 typedef struct sgl_label {
     sgl_obj_t        obj;
@@ -144,8 +220,10 @@ typedef struct sgl_label {
     uint8_t          alpha;
     uint8_t          align: 4;
     uint8_t          bg_flag : 1;
+    uint8_t          relayout : 1;
     int8_t           offset_x;
     int8_t           offset_y;
+    sgl_text_layout_t layout;
 }sgl_label_t;
 
 
@@ -157,16 +235,32 @@ typedef struct sgl_label {
 sgl_obj_t* sgl_label_create(sgl_obj_t* parent);
 
 
+/**
+ * @brief initialize a label object in storage of user, such as static memory
+ * @param label label storage, it's never freed by sgl
+ * @param parent parent of the label
+ * @param glyph glyph buffer of the text layout, NULL means the layout is allocated from heap
+ * @param glyph_num number of glyphs of the buffer, it should be not less than the characters
+ *        of the longest text of label
+ * @return pointer to the label object, NULL means failed
+ * @note the text that does not fit in the glyph buffer is drawn without layout
+ */
+sgl_obj_t* sgl_label_init(sgl_label_t *label, sgl_obj_t* parent, sgl_text_glyph_t *glyph, uint16_t glyph_num);
+
+
 /**
  * @brief set label text
  * @param obj pointer to the label object
  * @param text text to be set
  * @return none
+ * @note the label caches the layout of text, if you modify the content of text buffer,
+ *       you should call this function again to update the label
  */
 static inline void sgl_label_set_text(sgl_obj_t *obj, const char *text)
 {
     sgl_label_t *label = sgl_container_of(obj, sgl_label_t, obj);
     label->text = text;
+    label->relayout = 1;
     sgl_obj_set_dirty(obj);
 }
 
@@ -180,6 +274,7 @@ static inline void sgl_label_set_font(sgl_obj_t *obj, const sgl_font_t *font)
 {
     sgl_label_t *label = sgl_container_of(obj, sgl_label_t, obj);
     label->font = font;
+    label->relayout = 1;
     sgl_obj_set_dirty(obj);
 }
 
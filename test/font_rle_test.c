@@ -0,0 +1,269 @@
+/* source: font_rle_test.c
+ * Copyright (c) 2026-2028, Lishanwen
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sgl.h>
+#include <stdio.h>
+#include <string.h>
+
+
+#if !(CONFIG_SGL_FONT_COMPRESSED)
+#error "font_rle_test needs CONFIG_SGL_FONT_COMPRESSED"
+#endif
+
+
+#define  SURF_W                                  (96)
+#define  SURF_H                                  (64)
+#define  GLYPH_NUM                               (8)
+#define  GLYPH_W_MAX                             (80)
+#define  GLYPH_H_MAX                             (40)
+#define  BITMAP_MAX                              (GLYPH_W_MAX * GLYPH_H_MAX * 5 / 8 + 8)
+#define  SEEK_MAX                                (GLYPH_H_MAX)
+#define  ROUND_NUM                               (60)
+#define  DRAW_NUM                                (20)
+
+
+#define  CHECK(cond)                                                        \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            fail ++;                                                        \
+        }                                                                   \
+    } while (0)
+
+
+/* the reference decoder walks the bitstream pixel by pixel, the same as the font converter */
+typedef struct {
+    const uint8_t *in;
+    uint32_t rdp;
+    uint8_t bpp;
+    uint8_t state;
+    uint8_t count;
+    uint8_t prev_v;
+} ref_rle_t;
+
+
+static uint8_t rle_bitmap[GLYPH_NUM * BITMAP_MAX];
+static uint8_t raw_bitmap[GLYPH_NUM * GLYPH_W_MAX * GLYPH_H_MAX / 2];
+static uint8_t pixel[GLYPH_W_MAX * GLYPH_H_MAX];
+static sgl_font_table_t rle_table[GLYPH_NUM];
+static sgl_font_table_t raw_table[GLYPH_NUM];
+static sgl_font_rle_seek_t seek[GLYPH_NUM * SEEK_MAX];
+static uint32_t seek_offset[GLYPH_NUM];
+static sgl_color_t buf_rle[SURF_W * SURF_H];
+static sgl_color_t buf_raw[SURF_W * SURF_H];
+static uint32_t seed = 1;
+static int fail = 0;
+
+
+static int rand_range(int min, int max)
+{
+    seed = seed * 1103515245 + 12345;
+    return min + (int)((seed >> 16) % (uint32_t)(max - min + 1));
+}
+
+
+static uint8_t ref_bits(ref_rle_t *rle, uint8_t len)
+{
+    uint8_t v = 0;
+
+    for (uint8_t i = 0; i < len; i++, rle->rdp++) {
+        v = (v << 1) | ((rle->in[rle->rdp >> 3] >> (7 - (rle->rdp & 7))) & 1);
+    }
+
+    return v;
+}
+
+
+static uint8_t ref_single(ref_rle_t *rle)
+{
+    rle->prev_v = ref_bits(rle, rle->bpp);
+    rle->state = 0;
+    return rle->prev_v;
+}
+
+
+static uint8_t ref_next(ref_rle_t *rle)
+{
+    uint32_t rdp = rle->rdp;
+    uint8_t v;
+
+    if (rle->state == 0) {
+        v = ref_bits(rle, rle->bpp);
+        if (rdp != 0 && rle->prev_v == v) {
+            rle->count = 0;
+            rle->state = 1;
+        }
+        rle->prev_v = v;
+        return v;
+    }
+
+    if (rle->state == 1) {
+        rle->count ++;
+        if (ref_bits(rle, 1) == 0) {
+            return ref_single(rle);
+        }
+
+        if (rle->count == 11) {
+            rle->count = ref_bits(rle, 6);
+            if (rle->count == 0) {
+                return ref_single(rle);
+            }
+            rle->state = 2;
+        }
+        return rle->prev_v;
+    }
+
+    rle->count --;
+    if (rle->count == 0) {
+        return ref_single(rle);
+    }
+    return rle->prev_v;
+}
+
+
+/* the bytes of 0x00 and 0xFF make the repeated and counter states, the others make single pixels */
+static void make_bitstream(uint8_t *out, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        switch (rand_range(0, 3)) {
+        case 0: out[i] = 0xFF; break;
+        case 1: out[i] = 0x00; break;
+        default: out[i] = (uint8_t)rand_range(0, 255); break;
+        }
+    }
+}
+
+
+/* decode a glyph by the reference decoder, the state is recorded every step rows from row step */
+static uint32_t make_glyph(uint8_t *in, uint8_t *raw, uint8_t bpp, uint16_t w, uint16_t h, uint8_t step, sgl_font_rle_seek_t *entry)
+{
+    ref_rle_t rle = {.in = in, .bpp = bpp};
+    uint32_t num = 0, n = 0;
+
+    for (uint16_t y = 0; y < h; y++) {
+        if (step != 0 && y != 0 && y % step == 0) {
+            entry[num].rdp = rle.rdp;
+            entry[num].state = rle.state;
+            entry[num].count = rle.count;
+            entry[num].prev_v = rle.prev_v;
+            num ++;
+        }
+
+        for (uint16_t x = 0; x < w; x++) {
+            pixel[n ++] = ref_next(&rle);
+        }
+    }
+
+    /* the decoded pixels are packed as the raw font, the high bits are the first pixel */
+    memset(raw, 0, (n * bpp + 7) / 8);
+    for (uint32_t i = 0; i < n; i++) {
+        raw[i * bpp / 8] |= pixel[i] << (8 - bpp - (i * bpp) % 8);
+    }
+
+    return num;
+}
+
+
+static void fill_background(void)
+{
+    for (int i = 0; i < SURF_W * SURF_H; i++) {
+        buf_raw[i] = sgl_rgb(i * 7, i * 3, i * 5);
+    }
+    memcpy(buf_rle, buf_raw, sizeof(buf_raw));
+}
+
+
+/* the glyphs of random bitstreams are drawn clipped, the compressed glyph is same as the raw one */
+static void test_round(uint8_t bpp, uint8_t step, bool with_seek)
+{
+    uint32_t rle_pos = 0, raw_pos = 0, seek_num = 0;
+    uint16_t w, h;
+
+    for (int i = 0; i < GLYPH_NUM; i++) {
+        w = rand_range(1, GLYPH_W_MAX);
+        h = rand_range(1, GLYPH_H_MAX);
+
+        make_bitstream(&rle_bitmap[rle_pos], BITMAP_MAX);
+        seek_offset[i] = seek_num;
+        seek_num += make_glyph(&rle_bitmap[rle_pos], &raw_bitmap[raw_pos], bpp, w, h, step, &seek[seek_num]);
+
+        memcpy(&rle_table[i], &(sgl_font_table_t){.bitmap_index = rle_pos, .adv_w = w, .box_h = h, .box_w = w}, sizeof(sgl_font_table_t));
+        memcpy(&raw_table[i], &(sgl_font_table_t){.bitmap_index = raw_pos, .adv_w = w, .box_h = h, .box_w = w}, sizeof(sgl_font_table_t));
+        rle_pos += BITMAP_MAX;
+        raw_pos += (w * h * bpp + 7) / 8;
+    }
+
+    const sgl_font_t rle_font = {
+        .bitmap = rle_bitmap,
+        .table = rle_table,
+        .font_table_size = GLYPH_NUM,
+        .font_height = GLYPH_H_MAX,
+        .bpp = bpp,
+        .compress = 1,
+        .rle_seek = with_seek ? seek : NULL,
+        .rle_seek_offset = seek_offset,
+        .rle_seek_step = step,
+    };
+    const sgl_font_t raw_font = {
+        .bitmap = raw_bitmap,
+        .table = raw_table,
+        .font_table_size = GLYPH_NUM,
+        .font_height = GLYPH_H_MAX,
+        .bpp = bpp,
+    };
+
+    sgl_surf_t surf_rle = {.x2 = SURF_W - 1, .y2 = SURF_H - 1, .buffer = buf_rle, .size = SURF_W * SURF_H, .w = SURF_W, .h = SURF_H};
+    sgl_surf_t surf_raw = {.x2 = SURF_W - 1, .y2 = SURF_H - 1, .buffer = buf_raw, .size = SURF_W * SURF_H, .w = SURF_W, .h = SURF_H};
+
+    for (int i = 0; i < DRAW_NUM; i++) {
+        uint32_t index = rand_range(0, GLYPH_NUM - 1);
+        int16_t x = rand_range(-GLYPH_W_MAX / 2, SURF_W - 8);
+        int16_t y = rand_range(-GLYPH_H_MAX / 2, SURF_H - 8);
+        uint8_t alpha = rand_range(0, 1) ? SGL_ALPHA_MAX : rand_range(0, SGL_ALPHA_MAX);
+        sgl_area_t area = {
+            .x1 = rand_range(0, SURF_W / 2),
+            .y1 = rand_range(0, SURF_H / 2),
+            .x2 = rand_range(SURF_W / 2, SURF_W - 1),
+            .y2 = rand_range(SURF_H / 2, SURF_H - 1),
+        };
+
+        sgl_draw_character(&surf_raw, &area, x, y, index, SGL_COLOR_WHITE, alpha, &raw_font);
+        sgl_draw_character(&surf_rle, &area, x, y, index, SGL_COLOR_WHITE, alpha, &rle_font);
+    }
+
+    if (memcmp(buf_rle, buf_raw, sizeof(buf_raw)) != 0) {
+        printf("bpp %d, seek step %d%s: compressed glyph is different from raw glyph\n", bpp, step, with_seek ? "" : " without entries");
+        fail ++;
+    }
+}
+
+
+int main(void)
+{
+    static const uint8_t step[] = {0, 1, 2, 3, 5, 8, 16};
+
+    for (int round = 0; round < ROUND_NUM; round++) {
+        fill_background();
+        test_round(round % 2 ? 4 : 2, step[round % sizeof(step)], round % 5 != 0);
+    }
+
+    /* the entries are recorded as the converter does, one for every step rows from row step */
+    CHECK(make_glyph(rle_bitmap, raw_bitmap, 4, 4, 10, 3, seek) == 3);
+    CHECK(make_glyph(rle_bitmap, raw_bitmap, 4, 4, 10, 0, seek) == 0);
+
+    printf("font_rle_test: %s\n", fail ? "FAIL" : "PASS");
+    return fail ? 1 : 0;
+}
@@ -0,0 +1,142 @@
+/* source: mm_heap_test.c
+ * Copyright (c) 2026-2028, Lishanwen
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sgl_mm.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+#define  FAST_SIZE                               (16 * 1024)
+#define  BULK_SIZE                               (256 * 1024)
+
+
+#define  CHECK(cond)                                                        \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            fail ++;                                                        \
+        }                                                                   \
+    } while (0)
+
+
+static uint8_t fast_pool[FAST_SIZE];
+static uint8_t bulk_pool[BULK_SIZE];
+static int fail = 0;
+
+
+static bool in_pool(void *p, uint8_t *pool, size_t len)
+{
+    return (uint8_t*)p >= pool && (uint8_t*)p < pool + len;
+}
+
+
+/* fast pool is made of internal SRAM, bulk pool is made of external PSRAM on board */
+static void test_two_pools(void)
+{
+    sgl_mm_monitor_t fast, bulk, all;
+    size_t fast_base, bulk_base;
+    uint8_t *a, *b, *c, *d;
+
+    /* the pool is not aligned, and the bulk heap has no pool yet */
+    sgl_mm_init(fast_pool + 1, FAST_SIZE - 1);
+    a = sgl_malloc_hint(64, SGL_MM_HEAP_BULK);
+    CHECK(in_pool(a, fast_pool, FAST_SIZE));
+    CHECK(sgl_mm_get_heap_monitor(SGL_MM_HEAP_BULK).fallback_count == 1);
+    sgl_free(a);
+
+    sgl_mm_add_heap_pool(SGL_MM_HEAP_BULK, bulk_pool, BULK_SIZE);
+    fast = sgl_mm_get_heap_monitor(SGL_MM_HEAP_FAST);
+    bulk = sgl_mm_get_heap_monitor(SGL_MM_HEAP_BULK);
+    CHECK(fast.total_size == FAST_SIZE - 1);
+    CHECK(bulk.total_size == BULK_SIZE);
+    fast_base = fast.used_size;
+    bulk_base = bulk.used_size;
+
+    /* the hint selects the heap */
+    a = sgl_malloc(256);
+    b = sgl_malloc_hint(1024, SGL_MM_HEAP_BULK);
+    CHECK(in_pool(a, fast_pool, FAST_SIZE));
+    CHECK(in_pool(b, bulk_pool, BULK_SIZE));
+
+    /* the request that is larger than fast heap falls back to bulk heap */
+    c = sgl_malloc(FAST_SIZE);
+    CHECK(in_pool(c, bulk_pool, BULK_SIZE));
+    CHECK(sgl_mm_get_heap_monitor(SGL_MM_HEAP_FAST).fallback_count == 1);
+
+    /* the memory is moved to bulk heap with its content if fast heap is full */
+    memset(a, 0x5a, 256);
+    d = sgl_realloc(a, FAST_SIZE * 2);
+    CHECK(in_pool(d, bulk_pool, BULK_SIZE));
+    for (int i = 0; i < 256; i++) {
+        CHECK(d[i] == 0x5a);
+    }
+
+    fast = sgl_mm_get_heap_monitor(SGL_MM_HEAP_FAST);
+    bulk = sgl_mm_get_heap_monitor(SGL_MM_HEAP_BULK);
+    all = sgl_mm_get_monitor();
+    CHECK(fast.used_size == fast_base);
+    CHECK(bulk.used_size > bulk_base + FAST_SIZE * 3);
+    CHECK(all.used_size == fast.used_size + bulk.used_size);
+    CHECK(all.total_size == fast.total_size + bulk.total_size);
+
+    sgl_free(b);
+    sgl_free(c);
+    sgl_free(d);
+
+    fast = sgl_mm_get_heap_monitor(SGL_MM_HEAP_FAST);
+    bulk = sgl_mm_get_heap_monitor(SGL_MM_HEAP_BULK);
+    CHECK(fast.used_size == fast_base);
+    CHECK(bulk.used_size == bulk_base);
+    CHECK(bulk.frag_rate == 0);
+}
+
+
+/* the pool that is larger than 2^CONFIG_SGL_FL_INDEX_MAX is rejected, and the heap is kept empty */
+static void test_large_pool(void)
+{
+    size_t len = ((size_t)1 << CONFIG_SGL_FL_INDEX_MAX) * 4;
+    uint8_t *large = malloc(len);
+    sgl_mm_monitor_t bulk;
+    uint8_t *p;
+
+    sgl_mm_init(fast_pool, FAST_SIZE);
+    sgl_mm_add_heap_pool(SGL_MM_HEAP_BULK, large, len);
+    bulk = sgl_mm_get_heap_monitor(SGL_MM_HEAP_BULK);
+    CHECK(bulk.total_size == 0);
+
+    p = sgl_malloc_hint(64, SGL_MM_HEAP_BULK);
+    CHECK(in_pool(p, fast_pool, FAST_SIZE));
+    sgl_free(p);
+
+    /* the pool that fits is still accepted after the failure */
+    sgl_mm_add_heap_pool(SGL_MM_HEAP_BULK, large, (size_t)1 << (CONFIG_SGL_FL_INDEX_MAX - 1));
+    p = sgl_malloc_hint(64, SGL_MM_HEAP_BULK);
+    CHECK(in_pool(p, large, len));
+    sgl_free(p);
+
+    free(large);
+}
+
+
+int main(void)
+{
+    test_two_pools();
+    test_large_pool();
+
+    printf("mm_heap_test: %s\n", fail ? "FAIL" : "PASS");
+    return fail ? 1 : 0;
+}
@@ -0,0 +1,286 @@
+/* source: obj_tree_test.c
+ * Copyright (c) 2026-2028, Lishanwen
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sgl.h>
+#include <stdio.h>
+#include <string.h>
+
+
+#define  SCREEN_W                                (120)
+#define  SCREEN_H                                (90)
+#define  BAND_H                                  (10)
+#define  OBJ_MAX                                 (40)
+#define  CHAIN_DEPTH                             (12)
+#define  ROUND_NUM                               (300)
+
+
+#define  CHECK(cond)                                                        \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            fail ++;                                                        \
+        }                                                                   \
+    } while (0)
+
+
+static sgl_color_t band[SCREEN_W * BAND_H];
+static sgl_color_t frame[SCREEN_W * SCREEN_H];
+static sgl_color_t frame_inc[SCREEN_W * SCREEN_H];
+static sgl_obj_t *live[OBJ_MAX];
+static int live_num = 0;
+static int max_depth = 0;
+static uint32_t seed = 1;
+static int fail = 0;
+
+
+static void flush(sgl_area_t *area, sgl_color_t *src)
+{
+    for (int y = area->y1; y <= area->y2; y++) {
+        for (int x = area->x1; x <= area->x2; x++) {
+            frame[y * SCREEN_W + x] = *src++;
+        }
+    }
+
+    sgl_fbdev_flush_ready();
+}
+
+
+static int rand_range(int min, int max)
+{
+    seed = seed * 1103515245 + 12345;
+    return min + (int)((seed >> 16) % (uint32_t)(max - min + 1));
+}
+
+
+static sgl_obj_t* rand_obj(void)
+{
+    return live[rand_range(0, live_num - 1)];
+}
+
+
+/* sgl marks only the new area of object, the old area of subtree is pushed like application does */
+static void push_old_area(sgl_obj_t *obj)
+{
+    sgl_area_t area = obj->bbox;
+
+    if (sgl_area_selfclip(&area, &sgl_screen_act()->coords)) {
+        sgl_dirty_area_push(&area);
+    }
+}
+
+
+static void op_create(void)
+{
+    sgl_obj_t *parent = (live_num > 0 && rand_range(0, 3) > 0) ? live[live_num - 1 - rand_range(0, sgl_min(live_num - 1, 3))] : NULL;
+    sgl_obj_t *obj;
+
+    if (live_num >= OBJ_MAX) {
+        return;
+    }
+
+    obj = sgl_rect_create(parent);
+    if (obj == NULL) {
+        return;
+    }
+
+    sgl_obj_set_pos(obj, rand_range(-10, 40), rand_range(-10, 30));
+    sgl_obj_set_size(obj, rand_range(4, 60), rand_range(4, 50));
+    sgl_rect_set_color(obj, sgl_rgb(rand_range(0, 255), rand_range(0, 255), rand_range(0, 255)));
+    sgl_rect_set_radius(obj, rand_range(0, 6));
+    live[live_num ++] = obj;
+}
+
+
+static void op_move(void)
+{
+    sgl_obj_t *obj = rand_obj();
+
+    push_old_area(obj);
+    sgl_obj_set_pos(obj, rand_range(-20, 60), rand_range(-20, 50));
+}
+
+
+static void op_resize(void)
+{
+    sgl_obj_t *obj = rand_obj();
+
+    push_old_area(obj);
+    sgl_obj_set_size(obj, rand_range(2, 70), rand_range(2, 60));
+}
+
+
+static void op_shadow(void)
+{
+    sgl_obj_t *obj = rand_obj();
+
+    sgl_rect_set_shadow(obj, SGL_COLOR_BLACK, rand_range(0, 6), rand_range(0, 2), rand_range(-3, 3), rand_range(-3, 3), 128);
+}
+
+
+static void op_order(void)
+{
+    sgl_obj_t *obj = rand_obj();
+
+    push_old_area(obj);
+    switch (rand_range(0, 3)) {
+    case 0: sgl_obj_move_up(obj); break;
+    case 1: sgl_obj_move_down(obj); break;
+    case 2: sgl_obj_move_top(obj); break;
+    default: sgl_obj_move_bottom(obj); break;
+    }
+}
+
+
+/* the object is freed at next sync, so it and its descendants are dropped from the list at once */
+static void op_delete(void)
+{
+    sgl_obj_t *obj = rand_obj();
+    int num = 0;
+
+    for (int i = 0; i < live_num; i++) {
+        sgl_obj_t *node = live[i];
+        while (node != obj && node->parent != node && node->parent != NULL) {
+            node = node->parent;
+        }
+        if (node != obj) {
+            live[num ++] = live[i];
+        }
+    }
+
+    live_num = num;
+    sgl_obj_delete(obj);
+}
+
+
+/* the bounding box of every object is same as the one that is recomputed from scratch */
+static sgl_area_t check_bbox(sgl_obj_t *obj, int depth)
+{
+    sgl_area_t bbox = sgl_obj_get_draw_area(obj), sub;
+
+    max_depth = sgl_max(max_depth, depth);
+
+    for (sgl_obj_t *child = obj->child; child != NULL; child = child->sibling) {
+        sub = check_bbox(child, depth + 1);
+        sgl_area_selfmerge(&bbox, &sub);
+    }
+
+    if (memcmp(&bbox, &obj->bbox, sizeof(bbox)) != 0) {
+        printf("bbox of depth %d is (%d %d %d %d), it should be (%d %d %d %d)\n", depth,
+               obj->bbox.x1, obj->bbox.y1, obj->bbox.x2, obj->bbox.y2, bbox.x1, bbox.y1, bbox.x2, bbox.y2);
+        fail ++;
+    }
+
+    return bbox;
+}
+
+
+/* the prev link is the reverse of sibling link, and the tail is the last child */
+static void check_link(sgl_obj_t *obj)
+{
+    sgl_obj_t *last = NULL;
+
+    for (sgl_obj_t *child = obj->child; child != NULL; child = child->sibling) {
+        CHECK(child->parent == obj);
+        CHECK(child->prev == last);
+        CHECK(!sgl_obj_is_destroyed(child));
+        check_link(child);
+        last = child;
+    }
+
+    CHECK(obj->tail == last);
+}
+
+
+/* the frame that is drawn incrementally is same as the full redraw */
+static void check_frame(void)
+{
+    sgl_obj_t *page = sgl_screen_act();
+
+    memcpy(frame_inc, frame, sizeof(frame));
+    memset(frame, 0, sizeof(frame));
+    sgl_obj_set_dirty(page);
+    sgl_task_handle_sync();
+
+    if (memcmp(frame, frame_inc, sizeof(frame)) != 0) {
+        printf("incremental frame is different from full redraw\n");
+        fail ++;
+    }
+}
+
+
+int main(void)
+{
+    sgl_fbinfo_t fbinfo = {
+        .buffer = {band, NULL},
+        .buffer_size = SCREEN_W * BAND_H,
+        .xres = SCREEN_W,
+        .yres = SCREEN_H,
+        .flush_area = flush,
+    };
+
+    sgl_fbdev_register(&fbinfo);
+    sgl_init();
+    sgl_task_handle_sync();
+
+    /* a chain that is deeper than the old walk stack */
+    for (int i = 0; i < CHAIN_DEPTH; i++) {
+        sgl_obj_t *obj = sgl_rect_create(i == 0 ? NULL : live[i - 1]);
+        sgl_obj_set_pos(obj, 3, 2);
+        sgl_obj_set_size(obj, SCREEN_W - 6 * i, SCREEN_H - 5 * i);
+        sgl_rect_set_color(obj, sgl_rgb(i * 20, 255 - i * 20, i * 10));
+        live[live_num ++] = obj;
+    }
+    sgl_task_handle_sync();
+
+    for (int round = 0; round < ROUND_NUM && fail == 0; round++) {
+        for (int n = rand_range(1, 4); n > 0; n--) {
+            int op = rand_range(0, 9);
+
+            if (live_num == 0 || op < 3) {
+                op_create();
+            }
+            else if (op < 5) {
+                op_move();
+            }
+            else if (op == 5) {
+                op_resize();
+            }
+            else if (op == 6) {
+                op_shadow();
+            }
+            else if (op == 7) {
+                op_order();
+            }
+            else if (op == 8 || live_num > OBJ_MAX / 2) {
+                op_delete();
+            }
+        }
+
+        sgl_task_handle_sync();
+
+        check_bbox(sgl_screen_act(), 0);
+        check_link(sgl_screen_act());
+        check_frame();
+    }
+
+    CHECK(max_depth > 8);
+
+    sgl_obj_delete(NULL);
+    sgl_task_handle_sync();
+
+    printf("obj_tree_test: %s\n", fail ? "FAIL" : "PASS");
+    return fail ? 1 : 0;
+}
@@ -0,0 +1,220 @@
+/* source: pixmap_rle_test.c
+ * Copyright (c) 2026-2028, Lishanwen
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sgl.h>
+#include <stdio.h>
+#include <string.h>
+
+
+#define  SCREEN_W                                (320)
+#define  SCREEN_H                                (48)
+#define  BAND_H                                  (7)
+#define  PIXMAP_W_MAX                            (300)
+#define  PIXMAP_H_MAX                            (40)
+#define  RAW_MAX                                 (PIXMAP_W_MAX * PIXMAP_H_MAX * 4)
+#define  RLE_MAX                                 (PIXMAP_H_MAX * 4 + RAW_MAX + RAW_MAX / 128 + PIXMAP_H_MAX)
+#define  ROUND_NUM                               (40)
+#define  DRAW_NUM                                (8)
+
+
+static uint8_t raw[RAW_MAX];
+static uint8_t rle[RLE_MAX];
+static sgl_color_t band_raw[SCREEN_W * BAND_H];
+static sgl_color_t band_rle[SCREEN_W * BAND_H];
+static uint32_t seed = 1;
+static int fail = 0;
+
+
+static int rand_range(int min, int max)
+{
+    seed = seed * 1103515245 + 12345;
+    return min + (int)((seed >> 16) % (uint32_t)(max - min + 1));
+}
+
+
+/* a row is made of runs of one pixel, some longer than a packet, and literal pixels */
+static void make_image(uint8_t *out, uint16_t w, uint16_t h, uint8_t bytes)
+{
+    uint8_t pix[4];
+    int n;
+
+    for (uint16_t y = 0; y < h; y++) {
+        for (uint16_t x = 0; x < w; x += n) {
+            n = sgl_min(rand_range(0, 1) ? rand_range(1, 160) : rand_range(1, 12), w - x);
+
+            for (uint8_t k = 0; k < bytes; k++) {
+                pix[k] = (uint8_t)rand_range(0, 255);
+            }
+
+            /* the transparent and opaque pixels of RGBA8888 are the special cases of blending */
+            if (bytes == 4 && rand_range(0, 2) > 0) {
+                pix[3] = rand_range(0, 1) ? 0 : SGL_ALPHA_MAX;
+            }
+
+            for (int i = 0; i < n; i++) {
+                memcpy(out, pix, bytes);
+                if (n <= 12) {
+                    out[0] = (uint8_t)rand_range(0, 255);
+                }
+                out += bytes;
+            }
+        }
+    }
+}
+
+
+/* the encoder writes the row index, then the packets of every row, a packet has 128 pixels at most */
+static uint32_t encode_image(const uint8_t *in, uint8_t *out, uint16_t w, uint16_t h, uint8_t bytes)
+{
+    uint32_t pos = h * 4;
+    uint16_t x, n, lit;
+
+    for (uint16_t y = 0; y < h; y++) {
+        out[y * 4 + 0] = (uint8_t)pos;
+        out[y * 4 + 1] = (uint8_t)(pos >> 8);
+        out[y * 4 + 2] = (uint8_t)(pos >> 16);
+        out[y * 4 + 3] = (uint8_t)(pos >> 24);
+
+        for (x = 0; x < w; x += n) {
+            const uint8_t *p = &in[(y * w + x) * bytes];
+
+            for (n = 1; x + n < w && n < 128 && memcmp(p, p + n * bytes, bytes) == 0; n++);
+
+            if (n > 1) {
+                out[pos ++] = 0x80 | (n - 1);
+                memcpy(&out[pos], p, bytes);
+                pos += bytes;
+                continue;
+            }
+
+            /* the literal packet ends before the next run */
+            for (lit = 1; x + lit < w && lit < 128; lit++) {
+                if (x + lit + 1 < w && memcmp(p + lit * bytes, p + (lit + 1) * bytes, bytes) == 0) {
+                    break;
+                }
+            }
+
+            n = lit;
+            out[pos ++] = n - 1;
+            memcpy(&out[pos], p, n * bytes);
+            pos += n * bytes;
+        }
+    }
+
+    return pos;
+}
+
+
+static void fill_band(int16_t y)
+{
+    for (int i = 0; i < SCREEN_W * BAND_H; i++) {
+        band_raw[i] = sgl_rgb(i * 3, y * 5, i * 7);
+    }
+    memcpy(band_rle, band_raw, sizeof(band_raw));
+}
+
+
+/* the pixmap is drawn band by band, the RLE one is same as the raw one in every band */
+static void draw_bands(const sgl_pixmap_t *pm_raw, const sgl_pixmap_t *pm_rle, sgl_area_t *area, sgl_area_t *rect, int16_t radius, uint8_t alpha)
+{
+    sgl_surf_t surf = {
+        .x1 = 0,
+        .x2 = SCREEN_W - 1,
+        .size = SCREEN_W * BAND_H,
+        .w = SCREEN_W,
+        .h = BAND_H,
+    };
+
+    for (int16_t y = 0; y < SCREEN_H; y += BAND_H) {
+        surf.y1 = y;
+        surf.y2 = sgl_min(y + BAND_H, SCREEN_H) - 1;
+        fill_band(y);
+
+        surf.buffer = band_raw;
+        if (radius > 0) {
+            sgl_draw_fill_round_rect_pixmap(&surf, area, rect, radius, pm_raw, alpha);
+        }
+        else {
+            sgl_draw_fill_rect_pixmap(&surf, area, rect, pm_raw, alpha);
+        }
+
+        surf.buffer = band_rle;
+        if (radius > 0) {
+            sgl_draw_fill_round_rect_pixmap(&surf, area, rect, radius, pm_rle, alpha);
+        }
+        else {
+            sgl_draw_fill_rect_pixmap(&surf, area, rect, pm_rle, alpha);
+        }
+
+        for (int i = 0; i < SCREEN_W * BAND_H; i++) {
+            if (memcmp(&band_raw[i], &band_rle[i], sizeof(sgl_color_t)) != 0) {
+                printf("format %d: pixel (%d, %d) of RLE pixmap is different from raw pixmap\n",
+                       pm_rle->format, i % SCREEN_W, y + i / SCREEN_W);
+                fail ++;
+                return;
+            }
+        }
+    }
+}
+
+
+static void test_format(uint8_t raw_format, uint8_t rle_format, uint8_t bytes)
+{
+    uint16_t w = rand_range(1, PIXMAP_W_MAX);
+    uint16_t h = rand_range(1, PIXMAP_H_MAX);
+    uint32_t size;
+
+    make_image(raw, w, h, bytes);
+    size = encode_image(raw, rle, w, h, bytes);
+    SGL_ASSERT(size <= RLE_MAX);
+
+    sgl_pixmap_t pm_raw = {.width = w, .height = h, .format = raw_format, .bitmap.data = raw};
+    sgl_pixmap_t pm_rle = {.width = w, .height = h, .format = rle_format, .bitmap.data = rle};
+
+    for (int i = 0; i < DRAW_NUM; i++) {
+        /* the pixmap is placed at the center of rect, which is larger or smaller than it */
+        sgl_area_t rect = {.x1 = rand_range(-40, SCREEN_W / 2), .y1 = rand_range(-10, SCREEN_H / 2)};
+        rect.x2 = rect.x1 + w - 1 + rand_range(-20, 20);
+        rect.y2 = rect.y1 + h - 1 + rand_range(-6, 6);
+        rect.x2 = sgl_max(rect.x2, rect.x1);
+        rect.y2 = sgl_max(rect.y2, rect.y1);
+
+        sgl_area_t area = {
+            .x1 = rand_range(0, SCREEN_W / 2),
+            .y1 = rand_range(0, SCREEN_H / 2),
+            .x2 = rand_range(SCREEN_W / 2, SCREEN_W - 1),
+            .y2 = rand_range(SCREEN_H / 2, SCREEN_H - 1),
+        };
+        int16_t radius = rand_range(0, 2) ? 0 : rand_range(1, sgl_min(rect.x2 - rect.x1, rect.y2 - rect.y1) / 2 + 1);
+        uint8_t alpha = rand_range(0, 1) ? SGL_ALPHA_MAX : rand_range(0, SGL_ALPHA_MAX);
+
+        draw_bands(&pm_raw, &pm_rle, &area, &rect, radius, alpha);
+    }
+}
+
+
+int main(void)
+{
+    for (int round = 0; round < ROUND_NUM && fail == 0; round++) {
+        test_format(SGL_PIXMAP_FMT_RGB332, SGL_PIXMAP_FMT_RLE_RGB332, 1);
+        test_format(SGL_PIXMAP_FMT_RGB565, SGL_PIXMAP_FMT_RLE_RGB565, 2);
+        test_format(SGL_PIXMAP_FMT_RGB888, SGL_PIXMAP_FMT_RLE_RGB888, 3);
+        test_format(SGL_PIXMAP_FMT_RGBA8888, SGL_PIXMAP_FMT_RLE_RGBA8888, 4);
+    }
+
+    printf("pixmap_rle_test: %s\n", fail ? "FAIL" : "PASS");
+    return fail ? 1 : 0;
+}
@@ -0,0 +1,217 @@
+/* source: pixmap_stream_test.c
+ * Copyright (c) 2026-2028, Lishanwen
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <sgl.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+
+#if !(CONFIG_SGL_EXTERNAL_PIXMAP)
+#error "pixmap_stream_test needs CONFIG_SGL_EXTERNAL_PIXMAP"
+#endif
+
+
+#define  SCREEN_W                                (100)
+#define  SCREEN_H                                (60)
+#define  BAND_H                                  (10)
+#define  PIXMAP_SIZE                             (SCREEN_W * SCREEN_H * 2)
+#define  BLOCK_NUM                               ((PIXMAP_SIZE + CONFIG_SGL_PIXMAP_CACHE_BLOCK_SIZE - 1) / CONFIG_SGL_PIXMAP_CACHE_BLOCK_SIZE)
+#define  READ_DELAY_US                           (200)
+
+
+#define  CHECK(cond)                                                        \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            fail ++;                                                        \
+        }                                                                   \
+    } while (0)
+
+
+static sgl_color_t band[SCREEN_W * BAND_H];
+static sgl_color_t frame[SCREEN_W * SCREEN_H];
+static sgl_color_t frame_ext[SCREEN_W * SCREEN_H];
+static uint8_t bitmap[PIXMAP_SIZE];
+static int block_read[BLOCK_NUM];
+static int read_fail = 0;
+static FILE *flash = NULL;
+static int fail = 0;
+
+
+static void flush(sgl_area_t *area, sgl_color_t *src)
+{
+    for (int y = area->y1; y <= area->y2; y++) {
+        for (int x = area->x1; x <= area->x2; x++) {
+            frame[y * SCREEN_W + x] = *src++;
+        }
+    }
+
+    sgl_fbdev_flush_ready();
+}
+
+
+/* the temp file is the external flash, every read is counted by block and delayed */
+static int flash_read(size_t addr, uint8_t *buf, uint32_t len)
+{
+    struct timespec delay = {0, READ_DELAY_US * 1000};
+
+    nanosleep(&delay, NULL);
+
+    if (addr % CONFIG_SGL_PIXMAP_CACHE_BLOCK_SIZE != 0 || len != CONFIG_SGL_PIXMAP_CACHE_BLOCK_SIZE) {
+        read_fail ++;
+        return -1;
+    }
+
+    if (addr / CONFIG_SGL_PIXMAP_CACHE_BLOCK_SIZE < BLOCK_NUM) {
+        block_read[addr / CONFIG_SGL_PIXMAP_CACHE_BLOCK_SIZE] ++;
+    }
+
+    memset(buf, 0, len);
+    if (fseek(flash, (long)addr, SEEK_SET) != 0) {
+        read_fail ++;
+        return -1;
+    }
+
+    /* the tail of last block is out of file */
+    if (fread(buf, 1, len, flash) < len && ferror(flash)) {
+        read_fail ++;
+        return -1;
+    }
+
+    return 0;
+}
+
+
+/* the external background is same as the internal one, and every block is read once */
+static void test_page_background(void)
+{
+    sgl_pixmap_t internal = {
+        .width = SCREEN_W,
+        .height = SCREEN_H,
+        .format = SGL_PIXMAP_FMT_RGB565,
+        .bitmap.data = bitmap,
+    };
+    sgl_pixmap_t external = {
+        .width = SCREEN_W,
+        .height = SCREEN_H,
+        .format = SGL_PIXMAP_FMT_RGB565,
+        .external = 1,
+        .bitmap.addr = 0,
+    };
+
+    memset(block_read, 0, sizeof(block_read));
+    sgl_page_set_pixmap(sgl_screen_act(), &external);
+    sgl_task_handle_sync();
+    memcpy(frame_ext, frame, sizeof(frame));
+
+    CHECK(read_fail == 0);
+    for (int i = 0; i < BLOCK_NUM; i++) {
+        if (block_read[i] != 1) {
+            printf("block %d is read %d times\n", i, block_read[i]);
+            fail ++;
+        }
+    }
+
+    memset(frame, 0, sizeof(frame));
+    sgl_page_set_pixmap(sgl_screen_act(), &internal);
+    sgl_task_handle_sync();
+    CHECK(memcmp(frame, frame_ext, sizeof(frame)) == 0);
+}
+
+
+/* the edge pixels of circle are read pixel by pixel, they are same as the internal ones */
+static void test_circle_edge(void)
+{
+    static sgl_color_t buf_int[SCREEN_W * SCREEN_H];
+    static sgl_color_t buf_ext[SCREEN_W * SCREEN_H];
+    sgl_area_t area = {0, 0, SCREEN_W - 1, SCREEN_H - 1};
+    sgl_surf_t surf = {
+        .x1 = 0,
+        .y1 = 0,
+        .x2 = SCREEN_W - 1,
+        .y2 = SCREEN_H - 1,
+        .size = SCREEN_W * SCREEN_H,
+        .w = SCREEN_W,
+        .h = SCREEN_H,
+    };
+    sgl_pixmap_t internal = {
+        .width = SCREEN_W,
+        .height = SCREEN_H,
+        .format = SGL_PIXMAP_FMT_RGB565,
+        .bitmap.data = bitmap,
+    };
+    sgl_pixmap_t external = {
+        .width = SCREEN_W,
+        .height = SCREEN_H,
+        .format = SGL_PIXMAP_FMT_RGB565,
+        .external = 1,
+        .bitmap.addr = 0,
+    };
+
+    memset(buf_int, 0x5a, sizeof(buf_int));
+    surf.buffer = buf_int;
+    sgl_draw_fill_circle_pixmap(&surf, &area, 47, 31, 26, &internal, SGL_ALPHA_MAX, 40, 20);
+    sgl_draw_fill_circle_pixmap(&surf, &area, 20, 50, 18, &internal, 128, 10, 5);
+
+    read_fail = 0;
+    memset(buf_ext, 0x5a, sizeof(buf_ext));
+    surf.buffer = buf_ext;
+    sgl_draw_fill_circle_pixmap(&surf, &area, 47, 31, 26, &external, SGL_ALPHA_MAX, 40, 20);
+    sgl_draw_fill_circle_pixmap(&surf, &area, 20, 50, 18, &external, 128, 10, 5);
+
+    CHECK(read_fail == 0);
+    CHECK(memcmp(buf_int, buf_ext, sizeof(buf_int)) == 0);
+}
+
+
+int main(void)
+{
+    sgl_fbinfo_t fbinfo = {
+        .buffer = {band, NULL},
+        .buffer_size = SCREEN_W * BAND_H,
+        .xres = SCREEN_W,
+        .yres = SCREEN_H,
+        .flush_area = flush,
+    };
+    uint32_t seed = 1;
+
+    /* the pixmap has no flat area, so that any misplaced block is seen */
+    for (int i = 0; i < PIXMAP_SIZE; i++) {
+        seed = seed * 1103515245 + 12345;
+        bitmap[i] = (uint8_t)(seed >> 16);
+    }
+
+    flash = tmpfile();
+    if (flash == NULL || fwrite(bitmap, 1, sizeof(bitmap), flash) != sizeof(bitmap)) {
+        printf("pixmap_stream_test: FAIL, temp file can not be written\n");
+        return 1;
+    }
+
+    sgl_fbdev_register(&fbinfo);
+    sgl_pixmap_read_register(flash_read);
+    sgl_init();
+    sgl_task_handle_sync();
+
+    test_page_background();
+    test_circle_edge();
+
+    fclose(flash);
+    printf("pixmap_stream_test: %s\n", fail ? "FAIL" : "PASS");
+    return fail ? 1 : 0;
+}
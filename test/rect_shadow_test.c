@@ -0,0 +1,184 @@
+/* source: rect_shadow_test.c
+ * Copyright (c) 2026-2028, Lishanwen
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sgl.h>
+#include <stdio.h>
+#include <string.h>
+
+
+#define  SCREEN_W                                (240)
+#define  SCREEN_H                                (160)
+#define  BAND_H                                  (20)
+
+
+#define  CHECK(cond)                                                        \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            fail ++;                                                        \
+        }                                                                   \
+    } while (0)
+
+
+static sgl_color_t band[SCREEN_W * BAND_H];
+static int fail = 0;
+static int flush_num = 0;
+static int flush_bad = 0;
+
+
+static void flush(sgl_area_t *area, sgl_color_t *src)
+{
+    SGL_UNUSED(src);
+
+    flush_num ++;
+    if (area->x1 < 0 || area->y1 < 0 || area->x2 >= SCREEN_W || area->y2 >= SCREEN_H) {
+        flush_bad ++;
+    }
+
+    sgl_fbdev_flush_ready();
+}
+
+
+static sgl_obj_t* shadow_rect(int16_t x, int16_t y, uint8_t radius, uint8_t width)
+{
+    sgl_obj_t *obj = sgl_rect_create(NULL);
+
+    sgl_obj_set_pos(obj, x, y);
+    sgl_obj_set_size(obj, 40, 30);
+    sgl_rect_set_radius(obj, radius);
+    sgl_rect_set_shadow(obj, SGL_COLOR_BLACK, width, 2, 3, 3, 128);
+    return obj;
+}
+
+
+static void redraw(sgl_obj_t **obj, int num)
+{
+    for (int i = 0; i < num; i++) {
+        sgl_obj_set_dirty(obj[i]);
+    }
+    sgl_task_handle_sync();
+}
+
+
+/* the masks are got when shadow is set, so redraw never allocates with more keys than before */
+static void test_mask_shared(void)
+{
+    sgl_obj_t *obj[4];
+    size_t used, alloc;
+
+    /* the slab chunk of rectangles is carved before the base is got */
+    obj[0] = sgl_rect_create(NULL);
+    sgl_obj_delete(obj[0]);
+    sgl_task_handle_sync();
+    used = sgl_mm_get_monitor().used_size;
+
+    obj[0] = shadow_rect(10, 10, 4, 10);
+    obj[1] = shadow_rect(70, 10, 8, 12);
+    obj[2] = shadow_rect(130, 10, 12, 16);
+    obj[3] = shadow_rect(10, 80, 4, 10);
+    sgl_task_handle_sync();
+
+    CHECK(((sgl_rectangle_t*)obj[0])->desc.shadow_mask != NULL);
+    CHECK(((sgl_rectangle_t*)obj[0])->desc.shadow_mask == ((sgl_rectangle_t*)obj[3])->desc.shadow_mask);
+    CHECK(((sgl_rectangle_t*)obj[0])->desc.shadow_mask->ref == 2);
+
+    alloc = sgl_mm_get_monitor().alloc_count;
+    for (int i = 0; i < 3; i++) {
+        redraw(obj, 4);
+    }
+    CHECK(sgl_mm_get_monitor().alloc_count == alloc);
+
+    /* the radius of shadow shape is limited by the size, the mask is got again once */
+    sgl_obj_set_size(obj[2], 10, 10);
+    redraw(obj, 4);
+    CHECK(((sgl_rectangle_t*)obj[2])->desc.shadow_mask->radius == (9 + 2 * 2) / 2);
+    alloc = sgl_mm_get_monitor().alloc_count;
+    redraw(obj, 4);
+    CHECK(sgl_mm_get_monitor().alloc_count == alloc);
+
+    for (int i = 0; i < 4; i++) {
+        sgl_obj_delete(obj[i]);
+    }
+    sgl_task_handle_sync();
+    CHECK(sgl_system.shadow_mask == NULL);
+    CHECK(sgl_mm_get_monitor().used_size == used);
+}
+
+
+/* the shadow of object that is out of screen should not make the dirty area out of screen */
+static void test_offscreen(void)
+{
+    sgl_obj_t *obj = sgl_rect_create(NULL);
+
+    sgl_obj_set_pos(obj, 10, -40);
+    sgl_obj_set_size(obj, 20, 6);
+    sgl_task_handle_sync();
+
+    flush_bad = 0;
+    sgl_rect_set_shadow(obj, SGL_COLOR_BLACK, 8, 0, 0, 0, 128);
+    sgl_task_handle_sync();
+    CHECK(flush_bad == 0);
+
+    sgl_obj_delete(obj);
+    sgl_task_handle_sync();
+}
+
+
+/* the extension of shadow fits in ext_draw, the spread and width are limited */
+static void test_ext_limit(void)
+{
+    sgl_obj_t *obj = sgl_rect_create(NULL);
+    sgl_rectangle_t *rect = (sgl_rectangle_t*)obj;
+
+    sgl_obj_set_pos(obj, 100, 60);
+    sgl_obj_set_size(obj, 20, 20);
+    sgl_rect_set_shadow(obj, SGL_COLOR_BLACK, 255, 255, 100, -100, 128);
+    CHECK(sgl_draw_rect_shadow_ext(&rect->desc) <= 255);
+    CHECK(obj->ext_draw == sgl_draw_rect_shadow_ext(&rect->desc));
+    CHECK(rect->desc.shadow_spread == 155);
+
+    sgl_rect_set_shadow(obj, SGL_COLOR_BLACK, 255, 100, -20, 10, 128);
+    CHECK(obj->ext_draw == 100 + 255 / 2 + 20);
+    CHECK(rect->desc.shadow_spread == 100);
+    CHECK(rect->desc.shadow_width == 255);
+
+    sgl_obj_delete(obj);
+    sgl_task_handle_sync();
+}
+
+
+int main(void)
+{
+    sgl_fbinfo_t fbinfo = {
+        .buffer = {band, NULL},
+        .buffer_size = SCREEN_W * BAND_H,
+        .xres = SCREEN_W,
+        .yres = SCREEN_H,
+        .flush_area = flush,
+    };
+
+    sgl_fbdev_register(&fbinfo);
+    sgl_init();
+    sgl_task_handle_sync();
+
+    test_mask_shared();
+    test_offscreen();
+    test_ext_limit();
+    CHECK(flush_num > 0);
+
+    printf("rect_shadow_test: %s\n", fail ? "FAIL" : "PASS");
+    return fail ? 1 : 0;
+}